@@ -1,217 +1,516 @@
-/**********************************
- * FILE NAME: Application.cpp
- *
- * DESCRIPTION: Application layer class function definitions
- **********************************/
-
-#include "Application.h"
-
-void handler(int sig) {
-	void *array[10];
-	size_t size;
-
-	// get void*'s for all entries on the stack
-	size = backtrace(array, 10);
-
-	// print out all the frames to stderr
-	fprintf(stderr, "Error: signal %d:\n", sig);
-	backtrace_symbols_fd(array, size, STDERR_FILENO);
-	exit(1);
-}
-
-/**********************************
- * FUNCTION NAME: main
- *
- * DESCRIPTION: main function. Start from here
- **********************************/
-int main(int argc, char *argv[]) {
-	//signal(SIGSEGV, handler);
-	if ( argc != ARGS_COUNT ) {
-		cout<<"Configuration (i.e., *.conf) file File Required"<<endl;
-		return FAILURE;
-	}
-
-	// Create a new application object
-	Application *app = new Application(argv[1]);
-	// Call the run function
-	app->run();
-	// When done delete the application object
-	delete(app);
-
-	return SUCCESS;
-}
-
-/**
- * Constructor of the Application class
- */
-Application::Application(char *infile) {
-	int i;
-	par = new Params();
-	srand (time(NULL));
-	par->setparams(infile);
-	log = new Log(par);
-	en = new EmulNet(par);
-	mp1 = (MP1Node **) malloc(par->EN_GPSZ * sizeof(MP1Node *));
-
-	/*
-	 * Init all nodes
-	 */
-	for( i = 0; i < par->EN_GPSZ; i++ ) {
-		Member *memberNode = new Member;
-		memberNode->inited = false;
-		Address *addressOfMemberNode = new Address();
-		Address joinaddr;
-		joinaddr = getjoinaddr();
-		addressOfMemberNode = (Address *) en->ENinit(addressOfMemberNode, par->PORTNUM);
-		mp1[i] = new MP1Node(memberNode, par, en, log, addressOfMemberNode);
-		log->LOG(&(mp1[i]->getMemberNode()->addr), "APP");
-		delete addressOfMemberNode;
-	}
-}
-
-/**
- * Destructor
- */
-Application::~Application() {
-	delete log;
-	delete en;
-	for ( int i = 0; i < par->EN_GPSZ; i++ ) {
-		delete mp1[i];
-	}
-	free(mp1);
-	delete par;
-}
-
-/**
- * FUNCTION NAME: run
- *
- * DESCRIPTION: Main driver function of the Application layer
- */
-int Application::run()
-{
-	int i;
-	int timeWhenAllNodesHaveJoined = 0;
-	// boolean indicating if all nodes have joined
-	bool allNodesJoined = false;
-	srand(time(NULL));
-
-	// As time runs along
-	for( par->globaltime = 0; par->globaltime < TOTAL_RUNNING_TIME; ++par->globaltime ) {
-		// Run the membership protocol
-		mp1Run();
-		// Fail some nodes
-		fail();
-	}
-
-	// Clean up
-	en->ENcleanup();
-
-	for(i=0;i<=par->EN_GPSZ-1;i++) {
-		 mp1[i]->finishUpThisNode();
-	}
-
-	return SUCCESS;
-}
-
-/**
- * FUNCTION NAME: mp1Run
- *
- * DESCRIPTION:	This function performs all the membership protocol functionalities
- */
-void Application::mp1Run() {
-	int i;
-
-	// For all the nodes in the system
-	for( i = 0; i <= par->EN_GPSZ-1; i++) {
-
-		/*
-		 * Receive messages from the network and queue them in the membership protocol queue
-		 */
-		if( par->getcurrtime() > (int)(par->STEP_RATE*i) && !(mp1[i]->getMemberNode()->bFailed) ) {
-			// Receive messages from the network and queue them
-			mp1[i]->recvLoop();
-		}
-
-	}
-
-	// For all the nodes in the system
-	for( i = par->EN_GPSZ - 1; i >= 0; i-- ) {
-
-		/*
-		 * Introduce nodes into the distributed system
-		 */
-		if( par->getcurrtime() == (int)(par->STEP_RATE*i) ) {
-			// introduce the ith node into the system at time STEPRATE*i
-			mp1[i]->nodeStart(JOINADDR, par->PORTNUM);
-			cout<<i<<"-th introduced node is assigned with the address: "<<mp1[i]->getMemberNode()->addr.getAddress() << endl;
-			nodeCount += i;
-		}
-
-		/*
-		 * Handle all the messages in your queue and send heartbeats
-		 */
-		else if( par->getcurrtime() > (int)(par->STEP_RATE*i) && !(mp1[i]->getMemberNode()->bFailed) ) {
-			// handle messages and send heartbeats
-			mp1[i]->nodeLoop();
-			#ifdef DEBUGLOG
-			if( (i == 0) && (par->globaltime % 500 == 0) ) {
-				log->LOG(&mp1[i]->getMemberNode()->addr, "@@time=%d", par->getcurrtime());
-			}
-			#endif
-		}
-
-	}
-}
-
-/**
- * FUNCTION NAME: fail
- *
- * DESCRIPTION: This function controls the failure of nodes
- *
- * Note: this is used only by MP1
- */
-void Application::fail() {
-	int i, removed;
-
-	// fail half the members at time t=400
-	if( par->DROP_MSG && par->getcurrtime() == 50 ) {
-		par->dropmsg = 1;
-	}
-
-	if( par->SINGLE_FAILURE && par->getcurrtime() == 200 ) {
-		removed = (rand() % par->EN_GPSZ);
-		#ifdef DEBUGLOG
-		log->LOG(&mp1[removed]->getMemberNode()->addr, "Node failed at time=%d", par->getcurrtime());
-		#endif
-		mp1[removed]->getMemberNode()->bFailed = true;
-	}
-	else if( par->getcurrtime() == 200 ) {
-		removed = rand() % par->EN_GPSZ/2;
-		for ( i = removed; i < removed + par->EN_GPSZ/2; i++ ) {
-			#ifdef DEBUGLOG
-			log->LOG(&mp1[i]->getMemberNode()->addr, "Node failed at time = %d", par->getcurrtime());
-			#endif
-			mp1[i]->getMemberNode()->bFailed = true;
-		}
-	}
-
-	if( par->DROP_MSG && par->getcurrtime() == 300) {
-		par->dropmsg=0;
-	}
-
-}
-
-/**
- * FUNCTION NAME: getjoinaddr
- *
- * DESCRIPTION: This function returns the address of the coordinator
- */
-Address Application::getjoinaddr(void){
-	//trace.funcEntry("Application::getjoinaddr");
-    Address joinaddr;
-    joinaddr.init();
-    *(int *)(&(joinaddr.addr))=1;
-    *(short *)(&(joinaddr.addr[4]))=0;
-    //trace.funcExit("Application::getjoinaddr", SUCCESS);
-    return joinaddr;
-}
+/**********************************
+ * FILE NAME: Application.cpp
+ *
+ * DESCRIPTION: Application layer class function definitions
+ **********************************/
+
+#include "Application.h"
+
+void handler(int sig) {
+	void *array[10];
+	size_t size;
+
+	// get void*'s for all entries on the stack
+	size = backtrace(array, 10);
+
+	// print out all the frames to stderr
+	fprintf(stderr, "Error: signal %d:\n", sig);
+	backtrace_symbols_fd(array, size, STDERR_FILENO);
+	exit(1);
+}
+
+/**********************************
+ * FUNCTION NAME: main
+ *
+ * DESCRIPTION: main function. Start from here
+ **********************************/
+int main(int argc, char *argv[]) {
+	//signal(SIGSEGV, handler);
+	if ( argc != ARGS_COUNT ) {
+		cout<<"Configuration (i.e., *.conf) file File Required"<<endl;
+		return FAILURE;
+	}
+
+	// Create a new application object
+	Application *app = new Application(argv[1]);
+	// Call the run function
+	app->run();
+	// When done delete the application object
+	delete(app);
+
+	return SUCCESS;
+}
+
+/**
+ * Constructor of the Application class
+ */
+Application::Application(char *infile) {
+	int i;
+	par = new Params();
+	srand (time(NULL));
+	par->setparams(infile);
+	log = new Log(par);
+	shm = NULL;
+	if ( par->WORKERS > 1 ) {
+		shm = new ShmNet(par, par->WORKERS);
+		en = shm;
+	}
+	else if ( par->TRANSPORT == UDP_TRANSPORT ) {
+		en = new UdpNet(par, par->UDP_PORT);
+	}
+	else {
+		en = new EmulNet(par);
+	}
+	// Nodes share the transport, only the plain EmulNet knows parallel phases
+	pool = NULL;
+	events = NULL;
+	if ( par->THREADS > 1 && shm == NULL && par->TRANSPORT == EMUL_TRANSPORT ) {
+		pool = new ThreadPool(par->THREADS);
+	}
+	mp1 = (MP1Node **) malloc(par->EN_GPSZ * sizeof(MP1Node *));
+
+	/*
+	 * Init all nodes
+	 */
+	for( i = 0; i < par->EN_GPSZ; i++ ) {
+		Member *memberNode = new Member;
+		memberNode->inited = false;
+		Address *addressOfMemberNode = new Address();
+		Address joinaddr;
+		joinaddr = getjoinaddr();
+		addressOfMemberNode = (Address *) en->ENinit(addressOfMemberNode, par->PORTNUM);
+		mp1[i] = new MP1Node(memberNode, par, en, log, addressOfMemberNode);
+		log->LOG(&(mp1[i]->getMemberNode()->addr), "APP");
+		delete addressOfMemberNode;
+	}
+}
+
+/**
+ * Destructor
+ */
+Application::~Application() {
+	delete pool;
+	delete log;
+	delete en;
+	for ( int i = 0; i < par->EN_GPSZ; i++ ) {
+		delete mp1[i];
+	}
+	free(mp1);
+	delete par;
+}
+
+/**
+ * FUNCTION NAME: run
+ *
+ * DESCRIPTION: Main driver function of the Application layer
+ */
+int Application::run()
+{
+	int i;
+	int timeWhenAllNodesHaveJoined = 0;
+	// boolean indicating if all nodes have joined
+	bool allNodesJoined = false;
+	int worker = 0;
+	if ( shm ) {
+		worker = shm->spawn();
+	}
+	srand(time(NULL) + worker);
+
+	// The event engine drives one process and one thread over the emulated network
+	if ( par->ENGINE == EVENT_ENGINE && !shm && !pool && par->TRANSPORT == EMUL_TRANSPORT ) {
+		runEvents();
+	}
+	else {
+		runTicks();
+	}
+
+	// Clean up
+	en->ENcleanup();
+
+	// Convergence is the last change to any list, for the nodes this process hosts
+	int converged = 0;
+	long bytes = 0;
+	// Tick every live node knew the whole group by, -1 if one never did
+	int complete = 0;
+	for(i=0;i<=par->EN_GPSZ-1;i++) {
+		if ( hosts(i) ) {
+			mp1[i]->logStats();
+			converged = max(converged, mp1[i]->getLastChange());
+			bytes += mp1[i]->getGossipBytes();
+			if ( !mp1[i]->getMemberNode()->bFailed && complete >= 0 ) {
+				complete = mp1[i]->getCompleteAt() < 0 ? -1 : max(complete, mp1[i]->getCompleteAt());
+			}
+		}
+	}
+	cout<<"membership converged at "<<converged<<", "<<bytes<<" bytes of membership traffic"<<endl;
+	if ( complete >= 0 ) {
+		cout<<"every live node knew the whole group by "<<complete<<endl;
+	}
+	else {
+		cout<<"some live node never knew the whole group"<<endl;
+	}
+
+	if ( shm && worker == 0 ) {
+		shm->join();
+	}
+
+	return SUCCESS;
+}
+
+/**
+ * FUNCTION NAME: runTicks
+ *
+ * DESCRIPTION: Step every node at every tick until TOTAL_RUNNING_TIME
+ */
+void Application::runTicks() {
+	int i;
+
+	// As time runs along
+	for( par->globaltime = 0; par->globaltime < TOTAL_RUNNING_TIME; ) {
+		// Run the membership protocol
+		mp1Run();
+		// Fail some nodes
+		fail();
+		// Some nodes leave
+		leave();
+		if ( shm ) {
+			// Wait for the other workers, then pick up the failures they decided
+			par->globaltime = shm->tick();
+			for ( i = 0; i < par->EN_GPSZ; i++ ) {
+				if ( hosts(i) && shm->isFailed(i) ) {
+					mp1[i]->getMemberNode()->bFailed = true;
+				}
+			}
+		}
+		else {
+			++par->globaltime;
+		}
+	}
+}
+
+/**
+ * FUNCTION NAME: runEvents
+ *
+ * DESCRIPTION: Discrete event engine. Time jumps from one pending event to the next
+ * 				and a node is only visited when one of its events is due:
+ * 				- EV_RECV when the EmulNet puts a message for it in flight,
+ * 				- EV_TICK at its start time, then at MP1Node::nextWake, or in the tick
+ * 				  a message comes in if that is earlier,
+ * 				- EV_FAIL at the times fail() and leave() act on.
+ * 				A node skips the ticks in which it would only count its heartbeat.
+ * 				Events of one tick run receive phase first in ascending node order,
+ * 				then node phase in descending order, then fail() and leave(), the order of
+ * 				mp1Run, so the logs read the same as with the tick loop.
+ */
+void Application::runEvents() {
+	int i, start, next;
+	sim_event ev;
+
+	events = new EventQueue();
+	recvAt.assign(par->EN_GPSZ, -1);
+	tickAt.assign(par->EN_GPSZ, INT_MAX);
+	en->setDeliveryHook(&Application::onDelivery, this);
+
+	for ( i = 0; i < par->EN_GPSZ; i++ ) {
+		wake(i, (int)(par->STEP_RATE*i));
+	}
+	events->schedule(50, PHASE_APP, 0, EV_FAIL, -1);
+	events->schedule(200, PHASE_APP, 0, EV_FAIL, -1);
+	events->schedule(300, PHASE_APP, 0, EV_FAIL, -1);
+	if ( par->LEAVE_COUNT > 0 ) {
+		events->schedule(par->LEAVE_TIME, PHASE_APP, 0, EV_FAIL, -1);
+	}
+
+	while ( !events->empty() && events->nextTime() < TOTAL_RUNNING_TIME ) {
+		ev = events->pop();
+		par->globaltime = ev.time;
+		i = ev.node;
+
+		switch ( ev.kind ) {
+			case EV_RECV:
+				// Failed nodes leave their messages where they are
+				if ( mp1[i]->getMemberNode()->bFailed ) {
+					break;
+				}
+				start = (int)(par->STEP_RATE*i);
+				if ( ev.time <= start ) {
+					scheduleRecv(i, start + 1);
+					break;
+				}
+				mp1[i]->recvLoop();
+				wake(i, ev.time);
+				break;
+
+			case EV_TICK:
+				// Superseded by an earlier tick a message brought in
+				if ( ev.time != tickAt[i] ) {
+					break;
+				}
+				tickAt[i] = INT_MAX;
+				if ( ev.time == (int)(par->STEP_RATE*i) ) {
+					mp1[i]->nodeStart(JOINADDR, par->PORTNUM);
+					cout<<i<<"-th introduced node is assigned with the address: "<<mp1[i]->getMemberNode()->addr.getAddress() << endl;
+					nodeCount += i;
+					wake(i, ev.time + 1);
+				}
+				else if ( !mp1[i]->getMemberNode()->bFailed ) {
+					mp1[i]->nodeLoop();
+					next = mp1[i]->nextWake();
+					#ifdef DEBUGLOG
+					if( (i == 0) && (par->globaltime % 500 == 0) ) {
+						log->LOG(&mp1[i]->getMemberNode()->addr, "@@time=%d", par->getcurrtime());
+					}
+					// Node 0 marks the time in the log every 500 ticks
+					if ( i == 0 ) {
+						next = min(next, (ev.time / 500 + 1) * 500);
+					}
+					#endif
+					wake(i, next);
+				}
+				// A failed node never ticks again
+				break;
+
+			case EV_FAIL:
+				fail();
+				leave();
+				// Leaving nodes hand messages on until they stop
+				for ( i = 0; i < par->EN_GPSZ; i++ ) {
+					if ( mp1[i]->getMemberNode()->bLeaving && !mp1[i]->getMemberNode()->bFailed ) {
+						wake(i, ev.time + 1);
+					}
+				}
+				break;
+		}
+	}
+
+	par->globaltime = TOTAL_RUNNING_TIME;
+	en->setDeliveryHook(NULL, NULL);
+	cout<<"event engine: "<<events->getProcessed()<<" events"<<endl;
+	delete events;
+	events = NULL;
+}
+
+/**
+ * FUNCTION NAME: scheduleRecv
+ *
+ * DESCRIPTION: Make node i receive at the given time, once per time
+ */
+void Application::scheduleRecv(int i, int time) {
+	if ( recvAt[i] != time ) {
+		recvAt[i] = time;
+		events->schedule(time, PHASE_RECV, i, EV_RECV, i);
+	}
+}
+
+/**
+ * FUNCTION NAME: wake
+ *
+ * DESCRIPTION: Make sure node i ticks at time, unless it already ticks earlier
+ */
+void Application::wake(int i, int time) {
+	if ( time < tickAt[i] && time < TOTAL_RUNNING_TIME ) {
+		tickAt[i] = time;
+		events->schedule(time, PHASE_NODE, par->EN_GPSZ - 1 - i, EV_TICK, i);
+	}
+}
+
+/**
+ * FUNCTION NAME: onDelivery
+ *
+ * DESCRIPTION: EmulNet delivery hook of the event engine
+ */
+void Application::onDelivery(void *env, int dst, int time) {
+	Application *app = (Application *)env;
+
+	// Node ids start at 1
+	if ( dst >= 1 && dst <= app->par->EN_GPSZ ) {
+		app->scheduleRecv(dst - 1, time);
+	}
+}
+
+/**
+ * FUNCTION NAME: mp1Run
+ *
+ * DESCRIPTION:	This function performs all the membership protocol functionalities
+ */
+void Application::mp1Run() {
+	// For all the nodes in the system
+	forEachNode(en, false, [&](int i) {
+
+		if( !hosts(i) ) {
+			return;
+		}
+
+		/*
+		 * Receive messages from the network and queue them in the membership protocol queue
+		 */
+		if( par->getcurrtime() > (int)(par->STEP_RATE*i) && !(mp1[i]->getMemberNode()->bFailed) ) {
+			// Receive messages from the network and queue them
+			mp1[i]->recvLoop();
+		}
+
+	});
+
+	// For all the nodes in the system
+	forEachNode(en, true, [&](int i) {
+
+		if( !hosts(i) ) {
+			return;
+		}
+
+		/*
+		 * Introduce nodes into the distributed system
+		 */
+		if( par->getcurrtime() == (int)(par->STEP_RATE*i) ) {
+			// introduce the ith node into the system at time STEPRATE*i
+			mp1[i]->nodeStart(JOINADDR, par->PORTNUM);
+			std::lock_guard<std::mutex> guard(outLock);
+			cout<<i<<"-th introduced node is assigned with the address: "<<mp1[i]->getMemberNode()->addr.getAddress() << endl;
+			nodeCount += i;
+		}
+
+		/*
+		 * Handle all the messages in your queue and send heartbeats
+		 */
+		else if( par->getcurrtime() > (int)(par->STEP_RATE*i) && !(mp1[i]->getMemberNode()->bFailed) ) {
+			// handle messages and send heartbeats
+			mp1[i]->nodeLoop();
+			#ifdef DEBUGLOG
+			if( (i == 0) && (par->globaltime % 500 == 0) ) {
+				log->LOG(&mp1[i]->getMemberNode()->addr, "@@time=%d", par->getcurrtime());
+			}
+			#endif
+		}
+
+	});
+}
+
+/**
+ * FUNCTION NAME: forEachNode
+ *
+ * DESCRIPTION: Run step for every node index, the highest first if descending.
+ * 				With a thread pool every thread takes one contiguous chunk of the
+ * 				nodes and net runs in parallel mode until all chunks are done.
+ */
+void Application::forEachNode(EmulNet *net, bool descending, std::function<void(int)> step) {
+	int i;
+
+	if ( !pool ) {
+		for ( i = 0; i < par->EN_GPSZ; i++ ) {
+			step(descending ? par->EN_GPSZ - 1 - i : i);
+		}
+		return;
+	}
+
+	net->beginParallel(pool->getSize());
+	pool->run([&](int slot) {
+		int first = (long)par->EN_GPSZ * slot / pool->getSize();
+		int last = (long)par->EN_GPSZ * (slot + 1) / pool->getSize();
+
+		EmulNet::ENbind(slot);
+		for ( int j = first; j < last; j++ ) {
+			step(descending ? last - 1 - (j - first) : j);
+		}
+	});
+	net->endParallel();
+}
+
+/**
+ * FUNCTION NAME: fail
+ *
+ * DESCRIPTION: This function controls the failure of nodes
+ *
+ * Note: this is used only by MP1
+ */
+void Application::fail() {
+	int i, removed;
+
+	// fail half the members at time t=400
+	if( par->DROP_MSG && par->getcurrtime() == 50 ) {
+		par->dropmsg = 1;
+	}
+
+	// With several workers only the one hosting node 0 decides who fails
+	bool decides = hosts(0);
+
+	if( decides && par->SINGLE_FAILURE && par->getcurrtime() == 200 ) {
+		removed = (rand() % par->EN_GPSZ);
+		#ifdef DEBUGLOG
+		log->LOG(&mp1[removed]->getMemberNode()->addr, "Node failed at time=%d", par->getcurrtime());
+		#endif
+		failNode(removed);
+	}
+	else if( decides && par->getcurrtime() == 200 ) {
+		removed = rand() % par->EN_GPSZ/2;
+		for ( i = removed; i < removed + par->EN_GPSZ/2; i++ ) {
+			#ifdef DEBUGLOG
+			log->LOG(&mp1[i]->getMemberNode()->addr, "Node failed at time = %d", par->getcurrtime());
+			#endif
+			failNode(i);
+		}
+	}
+
+	if( par->DROP_MSG && par->getcurrtime() == 300) {
+		par->dropmsg=0;
+	}
+
+}
+
+/**
+ * FUNCTION NAME: leave
+ *
+ * DESCRIPTION: At LEAVE_TIME the LEAVE_COUNT highest-numbered nodes leave the group
+ * 				gracefully, see MP1Node::finishUpThisNode. Those that failed stay down.
+ * 				With several workers each one has the nodes it hosts leave.
+ */
+void Application::leave() {
+	int i;
+
+	if ( par->getcurrtime() != par->LEAVE_TIME ) {
+		return;
+	}
+	for ( i = par->EN_GPSZ - par->LEAVE_COUNT; i < par->EN_GPSZ; i++ ) {
+		if ( hosts(i) ) {
+			mp1[i]->finishUpThisNode();
+		}
+	}
+}
+
+/**
+ * FUNCTION NAME: hosts
+ *
+ * DESCRIPTION: True if node i runs in this process
+ */
+bool Application::hosts(int i) {
+	return shm == NULL || shm->hosts(i);
+}
+
+/**
+ * FUNCTION NAME: failNode
+ *
+ * DESCRIPTION: Fail node i. With several workers the failure is published and
+ * 				applied by the worker hosting the node at the end of the tick.
+ */
+void Application::failNode(int i) {
+	if ( shm ) {
+		shm->markFailed(i);
+	}
+	else {
+		mp1[i]->getMemberNode()->bFailed = true;
+	}
+}
+
+/**
+ * FUNCTION NAME: getjoinaddr
+ *
+ * DESCRIPTION: This function returns the address of the coordinator
+ */
+Address Application::getjoinaddr(void){
+	//trace.funcEntry("Application::getjoinaddr");
+    Address joinaddr;
+    joinaddr.init();
+    *(int *)(&(joinaddr.addr))=1;
+    *(short *)(&(joinaddr.addr[4]))=0;
+    //trace.funcExit("Application::getjoinaddr", SUCCESS);
+    return joinaddr;
+}
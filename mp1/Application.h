@@ -1,52 +1,77 @@
-/**********************************
- * FILE NAME: Application.h
- *
- * DESCRIPTION: Header file of all classes pertaining to the Application Layer
- **********************************/
-
-#ifndef _APPLICATION_H_
-#define _APPLICATION_H_
-
-#include "stdincludes.h"
-#include "MP1Node.h"
-#include "Log.h"
-#include "Params.h"
-#include "Member.h"
-#include "EmulNet.h"
-#include "Queue.h"
-
-/**
- * global variables
- */
-int nodeCount = 0;
-
-/*
- * Macros
- */
-#define ARGS_COUNT 2
-#define TOTAL_RUNNING_TIME 700
-
-/**
- * CLASS NAME: Application
- *
- * DESCRIPTION: Application layer of the distributed system
- */
-class Application{
-private:
-	// Address for introduction to the group
-	// Coordinator Node
-	char JOINADDR[30];
-	EmulNet *en;
-    Log *log;
-	MP1Node **mp1;
-	Params *par;
-public:
-	Application(char *);
-	virtual ~Application();
-	Address getjoinaddr();
-	int run();
-	void mp1Run();
-	void fail();
-};
-
-#endif /* _APPLICATION_H__ */
+/**********************************
+ * FILE NAME: Application.h
+ *
+ * DESCRIPTION: Header file of all classes pertaining to the Application Layer
+ **********************************/
+
+#ifndef _APPLICATION_H_
+#define _APPLICATION_H_
+
+#include "stdincludes.h"
+#include <atomic>
+#include "MP1Node.h"
+#include "Log.h"
+#include "Params.h"
+#include "Member.h"
+#include "EmulNet.h"
+#include "UdpNet.h"
+#include "ShmNet.h"
+#include "ThreadPool.h"
+#include "EventQueue.h"
+#include "Queue.h"
+
+/**
+ * global variables
+ */
+std::atomic<int> nodeCount(0);
+
+/*
+ * Macros
+ */
+#define ARGS_COUNT 2
+#define TOTAL_RUNNING_TIME 700
+
+/**
+ * CLASS NAME: Application
+ *
+ * DESCRIPTION: Application layer of the distributed system
+ */
+class Application{
+private:
+	// Address for introduction to the group
+	// Coordinator Node
+	char JOINADDR[30];
+	EmulNet *en;
+	// Same object as en when the nodes run in several worker processes
+	ShmNet *shm;
+	// Runs the nodes of each phase on THREADS threads, NULL for one
+	ThreadPool *pool;
+	// Keeps lines printed by different threads whole
+	std::mutex outLock;
+	// Pending events while the event engine runs
+	EventQueue *events;
+	// Last time an EV_RECV was scheduled for each node, and time of its next EV_TICK
+	vector<int> recvAt;
+	vector<int> tickAt;
+    Log *log;
+	MP1Node **mp1;
+	Params *par;
+public:
+	Application(char *);
+	virtual ~Application();
+	Address getjoinaddr();
+	int run();
+	void runTicks();
+	void runEvents();
+	void scheduleRecv(int i, int time);
+	void wake(int i, int time);
+	static void onDelivery(void *env, int dst, int time);
+	void mp1Run();
+	void fail();
+	void leave();
+	void forEachNode(EmulNet *net, bool descending, std::function<void(int)> step);
+	bool hosts(int i);
+	void failNode(int i);
+};
+
+#endif /* _APPLICATION_H__ */
@@ -1,220 +1,662 @@
-/**********************************
- * FILE NAME: EmulNet.cpp
- *
- * DESCRIPTION: Emulated Network classes definition
- **********************************/
-
-#include "EmulNet.h"
-
-/**
- * Constructor
- */
-EmulNet::EmulNet(Params *p)
-{
-	//trace.funcEntry("EmulNet::EmulNet");
-	int i,j;
-	par = p;
-	emulnet.setNextId(1);
-	emulnet.settCurrBuffSize(0);
-	enInited=0;
-	for ( i = 0; i < MAX_NODES; i++ ) {
-		for ( j = 0; j < MAX_TIME; j++ ) {
-			sent_msgs[i][j] = 0;
-			recv_msgs[i][j] = 0;
-		}
-	}
-	//trace.funcExit("EmulNet::EmulNet", SUCCESS);
-}
-
-/**
- * Copy constructor
- */
-EmulNet::EmulNet(EmulNet &anotherEmulNet) {
-	int i, j;
-	this->par = anotherEmulNet.par;
-	this->enInited = anotherEmulNet.enInited;
-	for ( i = 0; i < MAX_NODES; i++ ) {
-		for ( j = 0; j < MAX_TIME; j++ ) {
-			this->sent_msgs[i][j] = anotherEmulNet.sent_msgs[i][j];
-			this->recv_msgs[i][j] = anotherEmulNet.recv_msgs[i][j];
-		}
-	}
-	this->emulnet = anotherEmulNet.emulnet;
-}
-
-/**
- * Assignment operator overloading
- */
-EmulNet& EmulNet::operator =(EmulNet &anotherEmulNet) {
-	int i, j;
-	this->par = anotherEmulNet.par;
-	this->enInited = anotherEmulNet.enInited;
-	for ( i = 0; i < MAX_NODES; i++ ) {
-		for ( j = 0; j < MAX_TIME; j++ ) {
-			this->sent_msgs[i][j] = anotherEmulNet.sent_msgs[i][j];
-			this->recv_msgs[i][j] = anotherEmulNet.recv_msgs[i][j];
-		}
-	}
-	this->emulnet = anotherEmulNet.emulnet;
-	return *this;
-}
-
-/**
- * Destructor
- */
-EmulNet::~EmulNet() {}
-
-/**
- * FUNCTION NAME: ENinit
- *
- * DESCRIPTION: Init the emulnet for this node
- */
-void *EmulNet::ENinit(Address *myaddr, short port) {
-	// Initialize data structures for this member
-	*(int *)(myaddr->addr) = emulnet.nextid++;
-    *(short *)(&myaddr->addr[4]) = 0;
-	return myaddr;
-}
-
-/**
- * FUNCTION NAME: ENsend
- *
- * DESCRIPTION: EmulNet send function
- *
- * RETURNS:
- * size
- */
-int EmulNet::ENsend(Address *myaddr, Address *toaddr, char *data, int size) {
-	en_msg *em;
-	static char temp[2048];
-	int sendmsg = rand() % 100;
-
-	if( (emulnet.currbuffsize >= ENBUFFSIZE) || (size + (int)sizeof(en_msg) >= par->MAX_MSG_SIZE) || (par->dropmsg && sendmsg < (int) (par->MSG_DROP_PROB * 100)) ) {
-		return 0;
-	}
-
-	em = (en_msg *)malloc(sizeof(en_msg) + size);
-	em->size = size;
-
-	memcpy(&(em->from.addr), &(myaddr->addr), sizeof(em->from.addr));
-	memcpy(&(em->to.addr), &(toaddr->addr), sizeof(em->from.addr));
-	memcpy(em + 1, data, size);
-
-	emulnet.buff[emulnet.currbuffsize++] = em;
-
-	int src = *(int *)(myaddr->addr);
-	int time = par->getcurrtime();
-
-	assert(src <= MAX_NODES);
-	assert(time < MAX_TIME);
-
-	sent_msgs[src][time]++;
-
-	#ifdef DEBUGLOG
-		sprintf(temp, "Sending 4+%d B msg type %d to %d.%d.%d.%d:%d ", size-4, *(int *)data, toaddr->addr[0], toaddr->addr[1], toaddr->addr[2], toaddr->addr[3], *(short *)&toaddr->addr[4]);
-	#endif
-
-	return size;
-}
-
-/**
- * FUNCTION NAME: ENsend
- *
- * DESCRIPTION: EmulNet send function
- *
- * RETURNS:
- * size
- */
-int EmulNet::ENsend(Address *myaddr, Address *toaddr, string data) {
-	char * str = (char *) malloc(data.length() * sizeof(char));
-	memcpy(str, data.c_str(), data.size());
-	int ret = this->ENsend(myaddr, toaddr, str, (data.length() * sizeof(char)));
-	free(str);
-	return ret;
-}
-
-/**
- * FUNCTION NAME: ENrecv
- *
- * DESCRIPTION: EmulNet receive function
- *
- * RETURN:
- * 0
- */
-int EmulNet::ENrecv(Address *myaddr, int (* enq)(void *, char *, int), struct timeval *t, int times, void *queue){
-	// times is always assumed to be 1
-	int i;
-	char* tmp;
-	int sz;
-	en_msg *emsg;
-
-	for( i = emulnet.currbuffsize - 1; i >= 0; i-- ) {
-		emsg = emulnet.buff[i];
-
-		if ( 0 == strcmp(emsg->to.addr, myaddr->addr) ) {
-			sz = emsg->size;
-			tmp = (char *) malloc(sz * sizeof(char));
-			memcpy(tmp, (char *)(emsg+1), sz);
-
-			emulnet.buff[i] = emulnet.buff[emulnet.currbuffsize-1];
-			emulnet.currbuffsize--;
-
-			(*enq)(queue, (char *)tmp, sz);
-
-			free(emsg);
-
-			int dst = *(int *)(myaddr->addr);
-			int time = par->getcurrtime();
-
-			assert(dst <= MAX_NODES);
-			assert(time < MAX_TIME);
-
-			recv_msgs[dst][time]++;
-		}
-	}
-
-	return 0;
-}
-
-/**
- * FUNCTION NAME: ENcleanup
- *
- * DESCRIPTION: Cleanup the EmulNet. Called exactly once at the end of the program.
- */
-int EmulNet::ENcleanup() {
-	emulnet.nextid=0;
-	int i, j;
-	int sent_total, recv_total;
-
-	FILE* file = fopen("msgcount.log", "w+");
-
-	while(emulnet.currbuffsize > 0) {
-		free(emulnet.buff[--emulnet.currbuffsize]);
-	}
-
-	for ( i = 1; i <= par->EN_GPSZ; i++ ) {
-		fprintf(file, "node %3d ", i);
-		sent_total = 0;
-		recv_total = 0;
-
-		for (j = 0; j < par->getcurrtime(); j++) {
-
-			sent_total += sent_msgs[i][j];
-			recv_total += recv_msgs[i][j];
-			if (i != 67) {
-				fprintf(file, " (%4d, %4d)", sent_msgs[i][j], recv_msgs[i][j]);
-				if (j % 10 == 9) {
-					fprintf(file, "\n         ");
-				}
-			}
-			else {
-				fprintf(file, "special %4d %4d %4d\n", j, sent_msgs[i][j], recv_msgs[i][j]);
-			}
-		}
-		fprintf(file, "\n");
-		fprintf(file, "node %3d sent_total %6u  recv_total %6u\n\n", i, sent_total, recv_total);
-	}
-
-	fclose(file);
-	return 0;
-}
+/**********************************
+ * FILE NAME: EmulNet.cpp
+ *
+ * DESCRIPTION: Emulated Network classes definition
+ **********************************/
+
+#include "EmulNet.h"
+
+// Thread slot of the calling thread during a parallel phase
+static thread_local int enSlot = 0;
+
+/**
+ * Constructor
+ */
+EmulNet::EmulNet(Params *p)
+{
+	//trace.funcEntry("EmulNet::EmulNet");
+	par = p;
+	emulnet.setNextId(1);
+	emulnet.settCurrBuffSize(0);
+	enInited=0;
+	lossDrops = 0;
+	sizeDrops = 0;
+	overflowDrops = 0;
+	backPressured = 0;
+	pool.init(par->MAX_MSG_SIZE);
+	initWheel();
+	parallel = false;
+	queued = 0;
+	deliveryHook = NULL;
+	hookEnv = NULL;
+	//trace.funcExit("EmulNet::EmulNet", SUCCESS);
+}
+
+/**
+ * Copy constructor
+ */
+EmulNet::EmulNet(EmulNet &anotherEmulNet) {
+	this->par = anotherEmulNet.par;
+	this->enInited = anotherEmulNet.enInited;
+	this->lossDrops = anotherEmulNet.lossDrops;
+	this->sizeDrops = anotherEmulNet.sizeDrops;
+	this->overflowDrops = anotherEmulNet.overflowDrops;
+	this->backPressured = anotherEmulNet.backPressured;
+	this->pool.init(par->MAX_MSG_SIZE);
+	this->parallel = false;
+	this->queued = 0;
+	this->deliveryHook = NULL;
+	this->hookEnv = NULL;
+	this->wheel = anotherEmulNet.wheel;
+	this->wheelTime = anotherEmulNet.wheelTime;
+	this->wheelCount = anotherEmulNet.wheelCount;
+	this->egressFree = anotherEmulNet.egressFree;
+	this->sent_msgs = anotherEmulNet.sent_msgs;
+	this->recv_msgs = anotherEmulNet.recv_msgs;
+	this->emulnet = anotherEmulNet.emulnet;
+}
+
+/**
+ * Assignment operator overloading
+ */
+EmulNet& EmulNet::operator =(EmulNet &anotherEmulNet) {
+	this->par = anotherEmulNet.par;
+	this->enInited = anotherEmulNet.enInited;
+	this->lossDrops = anotherEmulNet.lossDrops;
+	this->sizeDrops = anotherEmulNet.sizeDrops;
+	this->overflowDrops = anotherEmulNet.overflowDrops;
+	this->backPressured = anotherEmulNet.backPressured;
+	this->wheel = anotherEmulNet.wheel;
+	this->wheelTime = anotherEmulNet.wheelTime;
+	this->wheelCount = anotherEmulNet.wheelCount;
+	this->egressFree = anotherEmulNet.egressFree;
+	this->sent_msgs = anotherEmulNet.sent_msgs;
+	this->recv_msgs = anotherEmulNet.recv_msgs;
+	this->emulnet = anotherEmulNet.emulnet;
+	return *this;
+}
+
+/**
+ * Destructor
+ */
+EmulNet::~EmulNet() {}
+
+/**
+ * FUNCTION NAME: ENinit
+ *
+ * DESCRIPTION: Init the emulnet for this node
+ */
+void *EmulNet::ENinit(Address *myaddr, short port) {
+	// Initialize data structures for this member
+	*(int *)(myaddr->addr) = emulnet.nextid++;
+    *(short *)(&myaddr->addr[4]) = 0;
+	return myaddr;
+}
+
+/**
+ * FUNCTION NAME: ENadmit
+ *
+ * DESCRIPTION: Decide whether a message of the given size gets into the buffer.
+ * 				Random loss (MSG_DROP_PROB), oversized messages and a full buffer are
+ * 				counted separately. A full buffer is handled by the EN_OVERFLOW policy.
+ *
+ * RETURNS:
+ * 1 if the message is admitted, 0 if it is dropped, EN_BACKPRESSURE if the sender should retry later
+ */
+int EmulNet::ENadmit(int size) {
+	std::unique_lock<std::mutex> guard(admitLock, std::defer_lock);
+	if ( parallel ) {
+		guard.lock();
+	}
+	int sendmsg = rand() % 100;
+
+	if ( size + (int)sizeof(en_msg) >= par->MAX_MSG_SIZE ) {
+		sizeDrops++;
+		return 0;
+	}
+	if ( par->dropmsg && sendmsg < (int) (par->MSG_DROP_PROB * 100) ) {
+		lossDrops++;
+		return 0;
+	}
+	if ( par->EN_BUFFSIZE > 0 && emulnet.currbuffsize + queued >= par->EN_BUFFSIZE ) {
+		if ( par->EN_OVERFLOW == BACK_PRESSURE ) {
+			backPressured++;
+			return EN_BACKPRESSURE;
+		}
+		overflowDrops++;
+		if ( !(par->EN_OVERFLOW == DROP_OLDEST && ENevictOldest()) ) {
+			return 0;
+		}
+	}
+	if ( parallel ) {
+		// Counted against the cap until endParallel puts it in the buffer
+		queued++;
+	}
+	return 1;
+}
+
+/**
+ * FUNCTION NAME: ENevictOldest
+ *
+ * DESCRIPTION: Evict the oldest message still in flight to make room for a new one.
+ * 				The message stays in its mailbox but is discarded instead of delivered.
+ *
+ * RETURNS:
+ * true if a message was evicted
+ */
+bool EmulNet::ENevictOldest() {
+	while ( !emulnet.sendorder.empty() ) {
+		en_msg *victim = emulnet.sendorder.front();
+		emulnet.sendorder.pop_front();
+		emulnet.firstseq++;
+		if ( victim ) {
+			victim->evicted = true;
+			emulnet.currbuffsize--;
+			return true;
+		}
+	}
+	return false;
+}
+
+/**
+ * FUNCTION NAME: ENprepare
+ *
+ * DESCRIPTION: Allocate the en_msg of an admitted message and fill in its header
+ */
+en_msg *EmulNet::ENprepare(Address *myaddr, Address *toaddr, int size) {
+	en_msg *em = (en_msg *)pool.alloc(sizeof(en_msg) + size);
+
+	em->size = size;
+	em->evicted = false;
+	em->channel = 0;
+	memcpy(&(em->from.addr), &(myaddr->addr), sizeof(em->from.addr));
+	memcpy(&(em->to.addr), &(toaddr->addr), sizeof(em->from.addr));
+
+	return em;
+}
+
+/**
+ * FUNCTION NAME: ENpost
+ *
+ * DESCRIPTION: Stamp the delivery tick of a filled en_msg and put it in flight
+ *
+ * RETURNS:
+ * size
+ */
+int EmulNet::ENpost(en_msg *em) {
+	char temp[2048];
+	int src = *(int *)(em->from.addr);
+	int now = par->getcurrtime();
+
+	em->deliverAt = now + ENdelay(src, *(int *)(em->to.addr), em->size);
+	if ( parallel ) {
+		outbox[enSlot].push_back(em);
+	}
+	else {
+		ENtransit(em);
+	}
+
+	countMsg(sent_msgs, src, now);
+
+	#ifdef DEBUGLOG
+		sprintf(temp, "Sending 4+%d B msg type %d to %d.%d.%d.%d:%d ", em->size-4, *(int *)(em+1), em->to.addr[0], em->to.addr[1], em->to.addr[2], em->to.addr[3], *(short *)&em->to.addr[4]);
+	#endif
+
+	return em->size;
+}
+
+/**
+ * FUNCTION NAME: ENtransit
+ *
+ * DESCRIPTION: Hand a message whose delivery tick is already set to the buffer.
+ * 				Messages due at the next tick go straight to the destination
+ * 				mailbox, later ones wait in the timing wheel.
+ */
+void EmulNet::ENtransit(en_msg *em) {
+	if ( deliveryHook ) {
+		deliveryHook(hookEnv, *(int *)(em->to.addr), max(em->deliverAt, par->getcurrtime() + 1));
+	}
+	if ( em->deliverAt <= par->getcurrtime() + 1 ) {
+		ENdeliver(em);
+	}
+	else {
+		wheel[em->deliverAt % wheel.size()].push_back(em);
+		wheelCount++;
+	}
+	emulnet.currbuffsize++;
+
+	em->seq = emulnet.nextseq++;
+	if ( par->EN_OVERFLOW == DROP_OLDEST ) {
+		emulnet.sendorder.push_back(em);
+	}
+}
+
+/**
+ * FUNCTION NAME: ENdelay
+ *
+ * DESCRIPTION: Ticks until a message sent now from src reaches dst.
+ * 				Every link has a fixed latency in [LATENCY_MIN, LATENCY_MAX], picked by
+ * 				hashing the link, plus up to LATENCY_JITTER ticks per message. With
+ * 				EGRESS_BW set, messages also queue behind earlier sends of the same node.
+ */
+int EmulNet::ENdelay(int src, int dst, int size) {
+	int delay = par->LATENCY_MIN;
+	int now = par->getcurrtime();
+
+	if ( par->LATENCY_MAX > par->LATENCY_MIN ) {
+		unsigned int link = (unsigned int)src * 2654435761u ^ (unsigned int)dst * 40503u;
+		delay += link % (par->LATENCY_MAX - par->LATENCY_MIN + 1);
+	}
+	if ( par->LATENCY_JITTER > 0 ) {
+		delay += rand() % (par->LATENCY_JITTER + 1);
+	}
+	if ( par->EGRESS_BW > 0 ) {
+		if ( src >= (int)egressFree.size() ) {
+			egressFree.resize(src + 1, 0);
+		}
+		double start = max((double)now, egressFree[src]);
+		egressFree[src] = start + (double)size / par->EGRESS_BW;
+		delay += (int)(egressFree[src] - now);
+	}
+	return delay;
+}
+
+/**
+ * FUNCTION NAME: ENdeliver
+ *
+ * DESCRIPTION: Put a message in the mailbox of its destination
+ */
+void EmulNet::ENdeliver(en_msg *em) {
+	int dst = *(int *)(em->to.addr);
+
+	assert(dst >= 0);
+	if ( dst >= (int)emulnet.mailbox.size() ) {
+		emulnet.mailbox.resize(dst + 1);
+	}
+	emulnet.mailbox[dst].push_back(em);
+}
+
+/**
+ * FUNCTION NAME: ENadvance
+ *
+ * DESCRIPTION: Move the messages that are due by now from the timing wheel to
+ * 				the mailboxes. Only the slots of the elapsed ticks are visited.
+ */
+void EmulNet::ENadvance() {
+	int now = par->getcurrtime();
+
+	if ( wheelCount == 0 ) {
+		wheelTime = now;
+		return;
+	}
+	while ( wheelTime < now ) {
+		wheelTime++;
+		vector<en_msg *> &slot = wheel[wheelTime % wheel.size()];
+		unsigned int kept = 0;
+		for ( unsigned int i = 0; i < slot.size(); i++ ) {
+			// Messages more than a wheel turn away stay for a later round
+			if ( slot[i]->deliverAt <= wheelTime ) {
+				ENdeliver(slot[i]);
+				wheelCount--;
+			}
+			else {
+				slot[kept++] = slot[i];
+			}
+		}
+		slot.resize(kept);
+	}
+}
+
+/**
+ * FUNCTION NAME: initWheel
+ *
+ * DESCRIPTION: Size the timing wheel so that link latencies fit in one turn
+ */
+void EmulNet::initWheel() {
+	unsigned int slots = EN_WHEELSLOTS;
+
+	while ( slots <= (unsigned int)(par->LATENCY_MAX + par->LATENCY_JITTER) ) {
+		slots *= 2;
+	}
+	wheel.assign(slots, vector<en_msg *>());
+	wheelTime = par->getcurrtime();
+	wheelCount = 0;
+}
+
+/**
+ * FUNCTION NAME: countMsg
+ *
+ * DESCRIPTION: Bump the traffic counter of a node at the given time, growing the
+ * 				table to cover the node and the time if needed
+ */
+void EmulNet::countMsg(vector< vector<int> > &counts, int node, int time) {
+	assert(node >= 0 && time >= 0);
+	if ( node >= (int)counts.size() ) {
+		counts.resize(node + 1);
+	}
+	if ( time >= (int)counts[node].size() ) {
+		counts[node].resize(time + 1, 0);
+	}
+	counts[node][time]++;
+}
+
+/**
+ * FUNCTION NAME: getMsgCount
+ *
+ * DESCRIPTION: Read a traffic counter, 0 if it was never bumped
+ */
+int EmulNet::getMsgCount(vector< vector<int> > &counts, int node, int time) {
+	if ( node >= (int)counts.size() || time >= (int)counts[node].size() ) {
+		return 0;
+	}
+	return counts[node][time];
+}
+
+/**
+ * FUNCTION NAME: ENsend
+ *
+ * DESCRIPTION: EmulNet send function
+ *
+ * RETURNS:
+ * size, 0 if the message was dropped, EN_BACKPRESSURE if the buffer is full
+ */
+int EmulNet::ENsend(Address *myaddr, Address *toaddr, char *data, int size) {
+	return ENsend(myaddr, toaddr, data, size, 0);
+}
+
+/**
+ * FUNCTION NAME: ENsend
+ *
+ * DESCRIPTION: EmulNet send function, for the protocol using channel
+ *
+ * RETURNS:
+ * size, 0 if the message was dropped, EN_BACKPRESSURE if the buffer is full
+ */
+int EmulNet::ENsend(Address *myaddr, Address *toaddr, char *data, int size, int channel) {
+	int admit = ENadmit(size);
+
+	if ( admit <= 0 ) {
+		return admit;
+	}
+	en_msg *em = ENprepare(myaddr, toaddr, size);
+	em->channel = channel;
+	memcpy((char *)(em + 1), data, size);
+
+	return ENpost(em);
+}
+
+/**
+ * FUNCTION NAME: ENsend
+ *
+ * DESCRIPTION: EmulNet send function
+ * 				The string is copied straight into the en_msg, which is later handed
+ * 				to the receiver as is
+ *
+ * RETURNS:
+ * size, 0 if the message was dropped, EN_BACKPRESSURE if the buffer is full
+ */
+int EmulNet::ENsend(Address *myaddr, Address *toaddr, string data) {
+	int size = data.length() * sizeof(char);
+	int admit = ENadmit(size);
+
+	if ( admit <= 0 ) {
+		return admit;
+	}
+	en_msg *em = ENprepare(myaddr, toaddr, size);
+	memcpy((char *)(em + 1), data.data(), size);
+
+	return ENpost(em);
+}
+
+/**
+ * FUNCTION NAME: ENrecv
+ *
+ * DESCRIPTION: EmulNet receive function
+ *
+ * RETURN:
+ * 0
+ */
+int EmulNet::ENrecv(Address *myaddr, int (* enq)(void *, char *, int), struct timeval *t, int times, void *queue){
+	// times is always assumed to be 1
+	int sz;
+	en_msg *emsg;
+	int dst = *(int *)(myaddr->addr);
+
+	// A parallel phase advanced the wheel when it began
+	if ( !parallel ) {
+		ENadvance();
+	}
+	if ( dst < 0 || dst >= (int)emulnet.mailbox.size() ) {
+		return 0;
+	}
+
+	// Only this node's mailbox is drained, newest message first
+	deque<en_msg *> &inbox = emulnet.mailbox[dst];
+	while ( !inbox.empty() ) {
+		emsg = inbox.back();
+		inbox.pop_back();
+		// Another thread may be evicting this very message
+		std::unique_lock<std::mutex> guard(admitLock, std::defer_lock);
+		if ( parallel && par->EN_OVERFLOW == DROP_OLDEST ) {
+			guard.lock();
+		}
+		if ( emsg->evicted ) {
+			pool.release(emsg);
+			continue;
+		}
+		if ( parallel ) {
+			slotRecv[enSlot]++;
+		}
+		else {
+			emulnet.currbuffsize--;
+		}
+		if ( par->EN_OVERFLOW == DROP_OLDEST ) {
+			emulnet.sendorder[emsg->seq - emulnet.firstseq] = NULL;
+			if ( !parallel ) {
+				ENtrimOrder();
+			}
+		}
+
+		// The queue takes ownership of the payload until ENrelease
+		sz = emsg->size;
+		(*enq)(queue, (char *)(emsg+1), sz);
+
+		countMsg(recv_msgs, dst, par->getcurrtime());
+	}
+
+	return 0;
+}
+
+/**
+ * FUNCTION NAME: ENrelease
+ *
+ * DESCRIPTION: Free a payload handed out by ENrecv, once the node has consumed it
+ */
+void EmulNet::ENrelease(void *payload) {
+	if ( payload ) {
+		pool.release((en_msg *)payload - 1);
+	}
+}
+
+/**
+ * FUNCTION NAME: ENchannel
+ *
+ * DESCRIPTION: Channel a payload handed out by ENrecv was sent on
+ */
+int EmulNet::ENchannel(void *payload) {
+	return ((en_msg *)payload - 1)->channel;
+}
+
+/**
+ * FUNCTION NAME: ENtrimOrder
+ *
+ * DESCRIPTION: Drop the delivered messages from the front of the send order
+ */
+void EmulNet::ENtrimOrder() {
+	while ( !emulnet.sendorder.empty() && !emulnet.sendorder.front() ) {
+		emulnet.sendorder.pop_front();
+		emulnet.firstseq++;
+	}
+}
+
+/**
+ * FUNCTION NAME: ENbind
+ *
+ * DESCRIPTION: Tell the EmulNet which thread slot the calling thread runs as
+ */
+void EmulNet::ENbind(int slot) {
+	enSlot = slot;
+}
+
+/**
+ * FUNCTION NAME: setDeliveryHook
+ *
+ * DESCRIPTION: Have hook(env, dst, time) called for every message put in flight,
+ * 				time being the first tick at which dst can receive it. NULL removes it.
+ */
+void EmulNet::setDeliveryHook(void (*hook)(void *env, int dst, int time), void *env) {
+	deliveryHook = hook;
+	hookEnv = env;
+}
+
+/**
+ * FUNCTION NAME: beginParallel
+ *
+ * DESCRIPTION: Start a phase in which slots threads send and receive at once, each
+ * 				for its own set of nodes. Everything the threads would otherwise
+ * 				grow or share is settled here: the wheel is advanced, the counter
+ * 				tables cover every node and the pool takes locks.
+ */
+void EmulNet::beginParallel(int slots) {
+	// Node ids may come from another EmulNet, the group size bounds them
+	int ids = max(emulnet.nextid, par->EN_GPSZ + 1);
+
+	ENadvance();
+	// Rows are only grown by the thread owning the node from here on
+	if ( (int)sent_msgs.size() < ids ) {
+		sent_msgs.resize(ids);
+	}
+	if ( (int)recv_msgs.size() < ids ) {
+		recv_msgs.resize(ids);
+	}
+	if ( par->EGRESS_BW > 0 && (int)egressFree.size() < ids ) {
+		egressFree.resize(ids, 0);
+	}
+	outbox.resize(slots);
+	slotRecv.assign(slots, 0);
+	queued = 0;
+	pool.setShared(true);
+	parallel = true;
+}
+
+/**
+ * FUNCTION NAME: endParallel
+ *
+ * DESCRIPTION: End a parallel phase. Deliveries are settled, then the outboxes are
+ * 				put in flight in slot order so the result does not depend on which
+ * 				thread finished first.
+ */
+void EmulNet::endParallel() {
+	parallel = false;
+	pool.setShared(false);
+	for ( unsigned int slot = 0; slot < slotRecv.size(); slot++ ) {
+		emulnet.currbuffsize -= slotRecv[slot];
+	}
+	ENtrimOrder();
+	for ( unsigned int slot = 0; slot < outbox.size(); slot++ ) {
+		for ( unsigned int i = 0; i < outbox[slot].size(); i++ ) {
+			ENtransit(outbox[slot][i]);
+		}
+		outbox[slot].clear();
+	}
+	queued = 0;
+}
+
+/**
+ * FUNCTION NAME: ENcleanup
+ *
+ * DESCRIPTION: Cleanup the EmulNet. Called exactly once at the end of the program.
+ */
+int EmulNet::ENcleanup() {
+	emulnet.nextid=0;
+
+	FILE* file = fopen("msgcount.log", "w+");
+
+	ENdrain();
+	ENreport(file, 1, par->EN_GPSZ);
+	ENreportDrops(file);
+
+	fclose(file);
+	return 0;
+}
+
+/**
+ * FUNCTION NAME: ENdrain
+ *
+ * DESCRIPTION: Return every message still in a mailbox or the timing wheel to the pool
+ */
+void EmulNet::ENdrain() {
+	int i, j;
+
+	for ( i = 0; i < (int)emulnet.mailbox.size(); i++ ) {
+		while ( !emulnet.mailbox[i].empty() ) {
+			pool.release(emulnet.mailbox[i].back());
+			emulnet.mailbox[i].pop_back();
+		}
+	}
+	for ( i = 0; i < (int)wheel.size(); i++ ) {
+		for ( j = 0; j < (int)wheel[i].size(); j++ ) {
+			pool.release(wheel[i][j]);
+		}
+		wheel[i].clear();
+	}
+	wheelCount = 0;
+	emulnet.currbuffsize = 0;
+	emulnet.sendorder.clear();
+}
+
+/**
+ * FUNCTION NAME: ENreport
+ *
+ * DESCRIPTION: Write the per tick sent / received counts of nodes first..last to file
+ */
+void EmulNet::ENreport(FILE *file, int first, int last) {
+	int i, j;
+	int sent_total, recv_total;
+	int sent, recv;
+
+	for ( i = first; i <= last; i++ ) {
+		fprintf(file, "node %3d ", i);
+		sent_total = 0;
+		recv_total = 0;
+
+		for (j = 0; j < par->getcurrtime(); j++) {
+
+			sent = getMsgCount(sent_msgs, i, j);
+			recv = getMsgCount(recv_msgs, i, j);
+			sent_total += sent;
+			recv_total += recv;
+			if (i != 67) {
+				fprintf(file, " (%4d, %4d)", sent, recv);
+				if (j % 10 == 9) {
+					fprintf(file, "\n         ");
+				}
+			}
+			else {
+				fprintf(file, "special %4d %4d %4d\n", j, sent, recv);
+			}
+		}
+		fprintf(file, "\n");
+		fprintf(file, "node %3d sent_total %6u  recv_total %6u\n\n", i, sent_total, recv_total);
+	}
+}
+
+/**
+ * FUNCTION NAME: ENreportDrops
+ *
+ * DESCRIPTION: Write the drop counters and the pool statistics to file
+ */
+void EmulNet::ENreportDrops(FILE *file) {
+	fprintf(file, "dropped: loss %ld  oversize %ld  overflow %ld  back-pressured %ld  (buffer cap %d, policy %d)\n", lossDrops, sizeDrops, overflowDrops, backPressured, par->EN_BUFFSIZE, par->EN_OVERFLOW);
+	pool.report(file);
+}
@@ -0,0 +1,74 @@
+/**********************************
+ * FILE NAME: EventQueue.cpp
+ *
+ * DESCRIPTION: Definition of the discrete event queue
+ **********************************/
+
+#include "EventQueue.h"
+
+/**
+ * Constructor
+ */
+EventQueue::EventQueue(): nextseq(0), processed(0) {}
+
+/**
+ * Destructor
+ */
+EventQueue::~EventQueue() {}
+
+/**
+ * FUNCTION NAME: schedule
+ *
+ * DESCRIPTION: Add an event
+ */
+void EventQueue::schedule(int time, int phase, int order, int kind, int node) {
+	sim_event ev;
+
+	ev.time = time;
+	ev.phase = phase;
+	ev.order = order;
+	ev.seq = nextseq++;
+	ev.kind = kind;
+	ev.node = node;
+	heap.push(ev);
+}
+
+/**
+ * FUNCTION NAME: empty
+ *
+ * DESCRIPTION: True if no event is pending
+ */
+bool EventQueue::empty() {
+	return heap.empty();
+}
+
+/**
+ * FUNCTION NAME: nextTime
+ *
+ * DESCRIPTION: Time of the earliest pending event. The queue must not be empty.
+ */
+int EventQueue::nextTime() {
+	return heap.top().time;
+}
+
+/**
+ * FUNCTION NAME: pop
+ *
+ * DESCRIPTION: Remove and return the earliest pending event
+ */
+sim_event EventQueue::pop() {
+	sim_event ev = heap.top();
+
+	heap.pop();
+	processed++;
+	return ev;
+}
+
+/**
+ * FUNCTION NAME: getProcessed
+ *
+ * DESCRIPTION: Number of events popped so far
+ */
+long EventQueue::getProcessed() {
+	return processed;
+}
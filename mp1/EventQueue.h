@@ -0,0 +1,78 @@
+/**********************************
+ * FILE NAME: EventQueue.h
+ *
+ * DESCRIPTION: Header file of the discrete event queue
+ **********************************/
+
+#ifndef _EVENTQUEUE_H_
+#define _EVENTQUEUE_H_
+
+#include "stdincludes.h"
+
+/*
+ * Macros
+ */
+// Phases of a tick, in the order the tick loop runs them
+#define PHASE_RECV 0
+#define PHASE_NODE 1
+#define PHASE_APP 2
+
+enum eventTYPE { EV_RECV, EV_TICK, EV_FAIL };
+
+/**
+ * STRUCT NAME: sim_event
+ *
+ * DESCRIPTION: Something that has to happen to a node, or to the application, at a
+ * 				given time. Events of one time run by phase, then by order, then in
+ * 				the order they were scheduled.
+ */
+typedef struct sim_event {
+	int time;
+	int phase;
+	int order;
+	long seq;
+	int kind;
+	int node;
+}sim_event;
+
+/**
+ * STRUCT NAME: laterEvent
+ *
+ * DESCRIPTION: Heap comparator, true if a runs after b
+ */
+struct laterEvent {
+	bool operator()(const sim_event &a, const sim_event &b) const {
+		if ( a.time != b.time ) {
+			return a.time > b.time;
+		}
+		if ( a.phase != b.phase ) {
+			return a.phase > b.phase;
+		}
+		if ( a.order != b.order ) {
+			return a.order > b.order;
+		}
+		return a.seq > b.seq;
+	}
+};
+
+/**
+ * CLASS NAME: EventQueue
+ *
+ * DESCRIPTION: Min-heap of pending events
+ */
+class EventQueue {
+private:
+	priority_queue<sim_event, vector<sim_event>, laterEvent> heap;
+	long nextseq;
+	long processed;
+public:
+	EventQueue();
+	void schedule(int time, int phase, int order, int kind, int node);
+	bool empty();
+	int nextTime();
+	sim_event pop();
+	long getProcessed();
+	virtual ~EventQueue();
+};
+
+#endif /* _EVENTQUEUE_H_ */
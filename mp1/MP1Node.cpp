@@ -1,427 +1,1667 @@
-/**********************************
- * FILE NAME: MP1Node.cpp
- *
- * DESCRIPTION: Membership protocol run by this Node.
- * 				Definition of MP1Node class functions.
- **********************************/
-
-#include "MP1Node.h"
-
-/*
- * Note: You can change/add any functions in MP1Node.{h,cpp}
- */
-
-/**
- * Overloaded Constructor of the MP1Node class
- * You can add new members to the class if you think it
- * is necessary for your logic to work
- */
-MP1Node::MP1Node(Member *member, Params *params, EmulNet *emul, Log *log, Address *address) {
-	for( int i = 0; i < 6; i++ ) {
-		NULLADDR[i] = 0;
-	}
-	this->memberNode = member;
-	this->emulNet = emul;
-	this->log = log;
-	this->par = params;
-	this->memberNode->addr = *address;
-}
-
-/**
- * Destructor of the MP1Node class
- */
-MP1Node::~MP1Node() {}
-
-/**
- * FUNCTION NAME: recvLoop
- *
- * DESCRIPTION: This function receives message from the network and pushes into the queue
- * 				This function is called by a node to receive messages currently waiting for it
- */
-int MP1Node::recvLoop() {
-    if ( memberNode->bFailed ) {
-    	return false;
-    }
-    else {
-    	return emulNet->ENrecv(&(memberNode->addr), enqueueWrapper, NULL, 1, &(memberNode->mp1q));
-    }
-}
-
-/**
- * FUNCTION NAME: enqueueWrapper
- *
- * DESCRIPTION: Enqueue the message from Emulnet into the queue
- */
-int MP1Node::enqueueWrapper(void *env, char *buff, int size) {
-	Queue q;
-	return q.enqueue((queue<q_elt> *)env, (void *)buff, size);
-}
-
-/**
- * FUNCTION NAME: nodeStart
- *
- * DESCRIPTION: This function bootstraps the node
- * 				All initializations routines for a member.
- * 				Called by the application layer.
- */
-void MP1Node::nodeStart(char *servaddrstr, short servport) {
-    Address joinaddr;
-    joinaddr = getJoinAddress();
-
-    // Self booting routines
-    if( initThisNode(&joinaddr) == -1 ) {
-#ifdef DEBUGLOG
-        log->LOG(&memberNode->addr, "init_thisnode failed. Exit.");
-#endif
-        exit(1);
-    }
-
-    if( !introduceSelfToGroup(&joinaddr) ) {
-        finishUpThisNode();
-#ifdef DEBUGLOG
-        log->LOG(&memberNode->addr, "Unable to join self to group. Exiting.");
-#endif
-        exit(1);
-    }
-
-    return;
-}
-
-/**
- * FUNCTION NAME: initThisNode
- *
- * DESCRIPTION: Find out who I am and start up
- */
-int MP1Node::initThisNode(Address *joinaddr) {
-	/*
-	 * This function is partially implemented and may require changes
-	 */
-	//int id = *(int*)(&memberNode->addr.addr);
-	//int port = *(short*)(&memberNode->addr.addr[4]);
-
-	memberNode->bFailed = false;
-	memberNode->inited = true;
-	memberNode->inGroup = false;
-    // node is up!
-	memberNode->nnb = 0;
-	memberNode->heartbeat = 0;
-	memberNode->pingCounter = TFAIL;
-	memberNode->timeOutCounter = -1;
-    initMemberListTable(memberNode);
-
-    return 0;
-}
-
-/**
- * FUNCTION NAME: introduceSelfToGroup
- *
- * DESCRIPTION: Join the distributed system
- */
-int MP1Node::introduceSelfToGroup(Address *joinaddr) {
-	MessageHdr *msg;
-#ifdef DEBUGLOG
-    static char s[1024];
-#endif
-
-    if ( 0 == memcmp((char *)&(memberNode->addr.addr), (char *)&(joinaddr->addr), sizeof(memberNode->addr.addr))) {
-        // I am the group booter (first process to join the group). Boot up the group
-#ifdef DEBUGLOG
-        log->LOG(&memberNode->addr, "Starting up group...");
-#endif
-        memberNode->inGroup = true;
-    }
-    else {
-        size_t msgsize = sizeof(MessageHdr) + sizeof(memberNode->addr.addr) + sizeof(long);
-        msg = (MessageHdr *) malloc(msgsize * sizeof(char));
-
-        // create JOINREQ message: format of data is {struct Address myaddr}
-        msg->msgType = JOINREQ;
-        cout<<"Request join with "<<memberNode->addr.getAddress()<<endl;
-        memcpy((char *)(msg+1), &memberNode->addr.addr, sizeof(memberNode->addr.addr));
-        memcpy((char *)(msg+1)+sizeof(memberNode->addr.addr), &memberNode->heartbeat, sizeof(long));
-
-#ifdef DEBUGLOG
-        sprintf(s, "Trying to join...");
-        log->LOG(&memberNode->addr, s);
-#endif
-
-        // send JOINREQ message to introducer member
-        emulNet->ENsend(&memberNode->addr, joinaddr, (char *)msg, msgsize);
-        //cout<<"Message sent"<<endl;
-        free(msg);
-    }
-
-    return 1;
-
-}
-/** 
-my implementation
-*/
-int MP1Node::gettime() {
-    return par->getcurrtime();
-}
-
-/**
- * FUNCTION NAME: finishUpThisNode
- *
- * DESCRIPTION: Wind up this node and clean up state
- */
-int MP1Node::finishUpThisNode(){
-   /*
-    * Your code goes here
-    */
-    return -1;
-}
-
-/**
- * FUNCTION NAME: nodeLoop
- *
- * DESCRIPTION: Executed periodically at each member
- * 				Check your messages in queue and perform membership protocol duties
- */
-void MP1Node::nodeLoop() {
-    if (memberNode->bFailed) {
-    	return;
-    }
-
-    // Check my messages
-    
-    checkMessages();
-    memberNode->heartbeat++;
-    // Wait until you're in the group...
-    if(!memberNode->inGroup ) {
-    	return;
-    }
-    //cout<<"node "<<memberNode->addr.getAddress()<<" sending HB at time = "<<gettime()<<" with ML size of "<<memberNode->memberList.size()<<endl;
-    //cout<<"node "<<memberNode->addr.getAddress()<<" entering node ops"<<endl;
-    // ...then jump in and share your responsibilites!
-    nodeLoopOps();
-
-    return;
-}
-
-/**
- * FUNCTION NAME: checkMessages
- *
- * DESCRIPTION: Check messages in the queue and call the respective message handler
- */
-void MP1Node::checkMessages() {
-    void *ptr;
-    int size;
-
-    // Pop waiting messages from memberNode's mp1q
-    while ( !memberNode->mp1q.empty() ) {
-    	ptr = memberNode->mp1q.front().elt;
-    	size = memberNode->mp1q.front().size;
-    	memberNode->mp1q.pop();
-    	recvCallBack((void *)memberNode, (char *)ptr, size);
-    }
-    return;
-}
-
-/**
- * FUNCTION NAME: recvCallBack
- *
- * DESCRIPTION: Message handler for different message types
- */
-void MP1Node::recvCallBack(void *env, char *data, int size ) {
-	/*
-	 * Your code goes here
-	 */
-    MsgTypes msgtype;
-    memcpy(&msgtype,data,sizeof(MsgTypes));
-    if (msgtype == JOINREQ) joinreq(data);
-    else if (msgtype == HEARTBEAT) {
-        memberNode->inGroup = true;
-        updatetables(data,size);
-    }
-    return;
-}
-/**
-* My implementation:
-This functions receives a heartbeat from another node and updates its own membership tables
-*/
-void MP1Node::updatetables(char* data, int size) {
-	//cout<<"updating tables"<<endl;
-    size_t currsize = sizeof(MessageHdr);
-    while (currsize < size_t(size)) {
-        long heartbeat;
-        memcpy(&heartbeat,data + currsize,sizeof(long));
-        char addr [6];
-        memcpy(&addr,data +currsize+sizeof(long),sizeof(addr));
-        int id;
-        short port;
-        memcpy(&id, &addr[0], sizeof(int));
-		memcpy(&port, &addr[4], sizeof(short));
-		string key = to_string(id) + ":" + to_string(port);
-		//cout<<key<<endl;
-        if (Address(key) == memberNode->addr){
-        	;
-        }
-        //if new node, add it to the table
-        else if (!nodetable.count(key)) {
-            nodetable.insert({ key,memberNode->memberList.size() });
-            Address tempaddr = Address(key);
-            log->logNodeAdd(&memberNode->addr,&tempaddr);
-            memberNode->memberList.push_back(MemberListEntry(id, port, heartbeat,gettime()));
-        }
-        else if (heartbeat > memberNode->memberList[nodetable[key]].heartbeat) {
-            memberNode->memberList[nodetable[key]].heartbeat = heartbeat;
-            memberNode->memberList[nodetable[key]].timestamp = gettime();
-        }
-        currsize += sizeof(Address) + sizeof(long);
-    }
-    //cout<<"exiting update tables"<<endl;
-    return;
-}
-/**
-My implementation: 
-The response when the message is a JOINREQ
-1. add the request node into the current nodes membership list.
-2. send response back to the request node with all the other nodes in the group
-*/
-void MP1Node::joinreq(char* data) {
-	//cout<<"responding to join req"<<endl;
-    char addr [6];
-    memcpy(&addr[0],data+sizeof(MessageHdr), sizeof(addr));
-    //get id, port
-    int id;
-    short port;
-    memcpy(&id, &addr[0], sizeof(int));
-	memcpy(&port, &addr[4], sizeof(short));
-	string key = to_string(id) + ":" + to_string(port);
-	//cout<<"node "<<memberNode->addr.getAddress()<<" sending ML to "<<Address(key).getAddress()<<endl;
-    //get heartbeat
-    long heartbeat;
-    memcpy(&heartbeat,data+sizeof(MessageHdr)+sizeof(addr), sizeof(long));
-    //insert new node into memberlist
-    Address tempaddr = Address(key);
-    log->logNodeAdd(&memberNode->addr,&tempaddr);
-    nodetable.insert({key,memberNode->memberList.size()});
-    memberNode->memberList.push_back(MemberListEntry(id, port,heartbeat,gettime()));
-    sendML(&tempaddr);
-    return;
-}
-
-/* 
-My implementation:
-This function sends the membership list of the current node to another node
-as a heartbeat message type
-*/
-void MP1Node::sendML(Address * addr) {
-    MessageHdr* msg;
-    size_t msgsize = sizeof(MessageHdr) + (memberNode->memberList.size() +1)* (sizeof(memberNode->addr.addr) + sizeof(long));
-    msg = (MessageHdr*) malloc(msgsize * sizeof(char));
-    msg->msgType = HEARTBEAT;
-    memcpy(msg +1, &memberNode->heartbeat, sizeof(long));
-    memcpy((char*)(msg + 1) +sizeof(long), &memberNode->addr.addr, sizeof(memberNode->addr.addr));
-    size_t offset = sizeof(MessageHdr) + sizeof(memberNode->addr.addr) + sizeof(long);
-    for (unsigned int i = 0; i < memberNode->memberList.size();i++) {
-    	char addr [6];
-    	if (gettime() - memberNode->memberList[i].timestamp > TFAIL) {
-    		msgsize -= sizeof(addr) + sizeof(long);
-    		continue;
-    	}
-        memcpy((char*)(msg)+ offset, &memberNode->memberList[i].heartbeat, sizeof(long));
-        int id = memberNode->memberList[i].id;
-        short port = memberNode->memberList[i].port;
-        memcpy(&addr[0], &id, sizeof(int));
-		memcpy(&addr[4], &port, sizeof(short));
-        memcpy((char*)msg + (offset+sizeof(long)), &addr, sizeof(addr));
-        offset += sizeof(long) +sizeof(addr);
-    }
-    //cout<<"memberlist size = "<<memberNode->memberList.size()<<", messagesize = "<<msgsize<<endl;
-    emulNet->ENsend(&memberNode->addr, addr, (char *)msg, msgsize);
-    //cout<<"send completed"<<endl;
-    free(msg); 
-    return;
-}
-/**
- * My implementation
- * FUNCTION NAME: nodeLoopOps
- *
- * DESCRIPTION: Check if any node hasn't responded within a timeout period and then delete
- * 				the nodes
- * 				Propagate your membership list
- */
-void MP1Node::nodeLoopOps() {
-    for (int i = 0; i < memberNode->memberList.size(); i++) {
-    	//cout<<"time since last = "<<gettime() - memberNode->memberList[i].timestamp<<endl;
-        if (gettime() - memberNode->memberList[i].timestamp > TREMOVE) {
-        	int id = memberNode->memberList[i].id;
-        	short port = memberNode->memberList[i].port;
-        	Address tempaddr(to_string(id) +":" +to_string(port));
-        	log->logNodeRemove(&memberNode->addr,&tempaddr);
-        	nodetable.erase(tempaddr.getAddress());
-        	memberNode->memberList[i] = memberNode->memberList.back();
-        	memberNode->memberList.pop_back();
-        	id = memberNode->memberList[i].id;
-        	port = memberNode->memberList[i].port;
-        	tempaddr = Address(to_string(id) +":" +to_string(port));
-        	nodetable[tempaddr.getAddress()] = i;
-        	i--;
-        }
-    }
-    //pick two random nodes and send a heartbeat
-    int node1;
-    Address addr1;
-    if (memberNode->memberList.size() > 0){
-    	node1 = rand() % memberNode->memberList.size();
-    	addr1 = createaddress(memberNode->memberList[node1].id, memberNode->memberList[node1].port);
-    	sendML(&addr1);
-    }
-    if (memberNode->memberList.size() > 1){
-    	int node2 = ((rand() % (memberNode->memberList.size()- 1)) + 1 + node1) % memberNode->memberList.size();
-    	//cout<<node2<<endl;
-    	Address addr2 = createaddress(memberNode->memberList[node2].id, memberNode->memberList[node2].port);
-    	sendML(&addr2);
-    	//cout<<"curr node: "<<memberNode->addr.getAddress()<<", Sent HB to "<<addr1.getAddress()<<", and "<<addr2.getAddress()<<endl;
-    }
-    return;
-}
-Address MP1Node::createaddress(int id, short port) {
-    return Address(to_string(id) + ":" + to_string(port));
-}
-/**
- * FUNCTION NAME: isNullAddress
- *
- * DESCRIPTION: Function checks if the address is NULL
- */
-int MP1Node::isNullAddress(Address *addr) {
-	return (memcmp(addr->addr, NULLADDR, 6) == 0 ? 1 : 0);
-}
-
-/**
- * FUNCTION NAME: getJoinAddress
- *
- * DESCRIPTION: Returns the Address of the coordinator
- */
-Address MP1Node::getJoinAddress() {
-    Address joinaddr;
-
-    memset(&joinaddr, 0, sizeof(Address));
-    *(int *)(&joinaddr.addr) = 1;
-    *(short *)(&joinaddr.addr[4]) = 0;
-
-    return joinaddr;
-}
-
-/**
- * FUNCTION NAME: initMemberListTable
- *
- * DESCRIPTION: Initialize the membership list
- */
-void MP1Node::initMemberListTable(Member *memberNode) {
-	memberNode->memberList.clear();
-}
-
-/**
- * FUNCTION NAME: printAddress
- *
- * DESCRIPTION: Print the Address
- */
-void MP1Node::printAddress(Address *addr)
-{
-    printf("%d.%d.%d.%d:%d \n",  addr->addr[0],addr->addr[1],addr->addr[2],
-                                                       addr->addr[3], *(short*)&addr->addr[4]) ;    
-}
+/**********************************
+ * FILE NAME: MP1Node.cpp
+ *
+ * DESCRIPTION: Membership protocol run by this Node.
+ * 				Definition of MP1Node class functions.
+ **********************************/
+
+#include "MP1Node.h"
+
+/*
+ * Note: You can change/add any functions in MP1Node.{h,cpp}
+ */
+
+/**
+ * FUNCTION NAME: putVarint
+ *
+ * DESCRIPTION: Append value to buf, seven bits per byte, low bits first, the high
+ * 				bit set on every byte but the last
+ */
+static void putVarint(vector<char> &buf, unsigned long long value) {
+    while (value >= 0x80) {
+        buf.push_back((char)(value | 0x80));
+        value >>= 7;
+    }
+    buf.push_back((char)value);
+}
+
+/**
+ * FUNCTION NAME: getVarint
+ *
+ * DESCRIPTION: Read a value written by putVarint and advance ptr past it
+ *
+ * RETURNS:
+ * false if the value runs past end
+ */
+static bool getVarint(const char *&ptr, const char *end, unsigned long long &value) {
+    value = 0;
+    for (int shift = 0; ptr < end && shift < 64; shift += 7) {
+        unsigned char byte = *ptr++;
+        value |= (unsigned long long)(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * FUNCTION NAME: zigzag
+ *
+ * DESCRIPTION: Map signed to unsigned so that small magnitudes give short varints,
+ * 				0, -1, 1, -2, ... to 0, 1, 2, 3, ...
+ */
+static unsigned long long zigzag(long value) {
+    return ((unsigned long long)value << 1) ^ (unsigned long long)(value >> 63);
+}
+
+/**
+ * FUNCTION NAME: unzigzag
+ *
+ * DESCRIPTION: Inverse of zigzag
+ */
+static long unzigzag(unsigned long long value) {
+    return (long)(value >> 1) ^ -(long)(value & 1);
+}
+
+/**
+ * Overloaded Constructor of the MP1Node class
+ * You can add new members to the class if you think it
+ * is necessary for your logic to work
+ */
+MP1Node::MP1Node(Member *member, Params *params, EmulNet *emul, Log *log, Address *address) {
+	for( int i = 0; i < 6; i++ ) {
+		NULLADDR[i] = 0;
+	}
+	this->memberNode = member;
+	this->emulNet = emul;
+	this->log = log;
+	this->par = params;
+	this->memberNode->addr = *address;
+	this->fullMsgs = 0;
+	this->fullBytes = 0;
+	this->deltaMsgs = 0;
+	this->deltaBytes = 0;
+	this->incarnation = 0;
+	this->nextSeq = 0;
+	this->probeSeq = 0;
+	this->probeStart = 0;
+	this->probeAcked = false;
+	this->probeIndirect = false;
+	this->probeTarget = NODEKEY_EMPTY;
+	this->probeNext = 0;
+	this->swimMsgs = 0;
+	this->swimBytes = 0;
+	this->suspicions = 0;
+	this->refutations = 0;
+	gossip_sync sync = {-1, -1, -1, -1, -1, NODEKEY_EMPTY};
+	this->gossipSync = sync;
+	this->gossipChunkRoom = par->MAX_MSG_SIZE;
+	this->hbCacheTime = -1;
+	this->gossipInterval = params->GOSSIP_INTERVAL;
+	this->lastGossip = -1;
+	this->nextGossip = 0;
+	this->lastChange = 0;
+	this->completeAt = -1;
+	this->joinSeed = 0;
+	this->joinRetryAt = 0;
+	this->joinsAnswered = 0;
+	this->joinRetries = 0;
+	this->piggyback = false;
+	this->piggybackQuiet = 0;
+	this->piggyMsgs = 0;
+	this->piggyBytes = 0;
+	this->gossipSkipped = 0;
+	this->removals = 0;
+	this->falsePositives = 0;
+	this->latencySum = 0;
+	this->latencyMax = 0;
+	this->leaveAt = -1;
+	this->leaveMsgs = 0;
+	this->leaveBytes = 0;
+}
+
+/**
+ * Destructor of the MP1Node class
+ */
+MP1Node::~MP1Node() {}
+
+/**
+ * FUNCTION NAME: recvLoop
+ *
+ * DESCRIPTION: This function receives message from the network and pushes into the queue
+ * 				This function is called by a node to receive messages currently waiting for it
+ */
+int MP1Node::recvLoop() {
+    if ( memberNode->bFailed ) {
+    	return false;
+    }
+    else {
+    	return emulNet->ENrecv(&(memberNode->addr), enqueueWrapper, NULL, 1, &(memberNode->mp1q));
+    }
+}
+
+/**
+ * FUNCTION NAME: enqueueWrapper
+ *
+ * DESCRIPTION: Enqueue the message from Emulnet into the queue
+ */
+int MP1Node::enqueueWrapper(void *env, char *buff, int size) {
+	Queue q;
+	return q.enqueue((queue<q_elt> *)env, (void *)buff, size);
+}
+
+/**
+ * FUNCTION NAME: nodeStart
+ *
+ * DESCRIPTION: This function bootstraps the node
+ * 				All initializations routines for a member.
+ * 				Called by the application layer.
+ */
+void MP1Node::nodeStart(char *servaddrstr, short servport) {
+    Address joinaddr;
+    joinaddr = getJoinAddress();
+
+    // Self booting routines
+    if( initThisNode(&joinaddr) == -1 ) {
+#ifdef DEBUGLOG
+        log->LOG(&memberNode->addr, "init_thisnode failed. Exit.");
+#endif
+        exit(1);
+    }
+
+    if( !introduceSelfToGroup(&joinaddr) ) {
+        finishUpThisNode();
+#ifdef DEBUGLOG
+        log->LOG(&memberNode->addr, "Unable to join self to group. Exiting.");
+#endif
+        exit(1);
+    }
+
+    return;
+}
+
+/**
+ * FUNCTION NAME: initThisNode
+ *
+ * DESCRIPTION: Find out who I am and start up
+ */
+int MP1Node::initThisNode(Address *joinaddr) {
+	/*
+	 * This function is partially implemented and may require changes
+	 */
+	//int id = *(int*)(&memberNode->addr.addr);
+	//int port = *(short*)(&memberNode->addr.addr[4]);
+
+	memberNode->bFailed = false;
+	memberNode->inited = true;
+	memberNode->inGroup = false;
+    // node is up!
+	memberNode->nnb = 0;
+	memberNode->heartbeat = 0;
+	loopedAt = gettime();
+	memberNode->pingCounter = TFAIL;
+	memberNode->timeOutCounter = -1;
+    initMemberListTable(memberNode);
+
+    return 0;
+}
+
+/**
+ * FUNCTION NAME: introduceSelfToGroup
+ *
+ * DESCRIPTION: Join the distributed system
+ */
+int MP1Node::introduceSelfToGroup(Address *joinaddr) {
+	MessageHdr *msg;
+#ifdef DEBUGLOG
+    char s[1024];
+#endif
+
+    if ( 0 == memcmp((char *)&(memberNode->addr.addr), (char *)&(joinaddr->addr), sizeof(memberNode->addr.addr))) {
+        // I am the group booter (first process to join the group). Boot up the group
+#ifdef DEBUGLOG
+        log->LOG(&memberNode->addr, "Starting up group...");
+#endif
+        memberNode->inGroup = true;
+    }
+    else {
+        size_t msgsize = sizeof(MessageHdr) + sizeof(memberNode->addr.addr) + sizeof(long);
+        msg = (MessageHdr *) malloc(msgsize * sizeof(char));
+
+        // create JOINREQ message: format of data is {struct Address myaddr}
+        msg->msgType = JOINREQ;
+        cout<<"Request join with "<<memberNode->addr.getAddress()<<endl;
+        memcpy((char *)(msg+1), &memberNode->addr.addr, sizeof(memberNode->addr.addr));
+        memcpy((char *)(msg+1)+sizeof(memberNode->addr.addr), &memberNode->heartbeat, sizeof(long));
+
+#ifdef DEBUGLOG
+        sprintf(s, "Trying to join...");
+        log->LOG(&memberNode->addr, s);
+#endif
+
+        // send JOINREQ message to introducer member
+        emulNet->ENsend(&memberNode->addr, joinaddr, (char *)msg, msgsize);
+        //cout<<"Message sent"<<endl;
+        free(msg);
+        // A busy seed gets longer to answer each time it is asked again
+        joinRetryAt = gettime() + (par->JOIN_TIMEOUT << min(joinRetries, (long)JOIN_BACKOFF_MAX));
+    }
+
+    return 1;
+
+}
+/** 
+my implementation
+*/
+int MP1Node::gettime() {
+    return par->getcurrtime();
+}
+
+/**
+ * FUNCTION NAME: finishUpThisNode
+ *
+ * DESCRIPTION: Wind up this node by leaving the group. Every member gets a LEAVE and
+ * 				drops this node right away, a MEMBER_LEFT event about this node has the
+ * 				KV store hand its keys off, and the node keeps handing KV messages on
+ * 				for LEAVE_LINGER ticks before it stops, see nodeLoop.
+ *
+ * RETURNS:
+ * 0 if the leave was announced, -1 if the node is not in the group
+ */
+int MP1Node::finishUpThisNode(){
+    if (memberNode->bFailed || memberNode->bLeaving || !memberNode->inGroup) {
+        return -1;
+    }
+#ifdef DEBUGLOG
+    log->LOG(&memberNode->addr, "Leaving the group...");
+#endif
+    vector<nodekey> self(1, selfKey());
+    for (int i = 0; i < memberNode->memberList.size(); i++) {
+        sendLeave(memberNode->memberList.getkey(i), self);
+    }
+    leaveAt = gettime();
+    memberNode->bLeaving = true;
+    publishEvent(MEMBER_LEFT, keyId(selfKey()), keyPort(selfKey()));
+    return 0;
+}
+
+/**
+ * FUNCTION NAME: logStats
+ *
+ * DESCRIPTION: Log the traffic and detector statistics of this node
+ */
+void MP1Node::logStats() {
+    log->LOG(&memberNode->addr, "#STATSLOG# membership last changed at %d, %ld B sent", lastChange, getGossipBytes());
+    log->LOG(&memberNode->addr, "#STATSLOG# joins %ld answered, %ld retried, whole group known at %d", joinsAnswered, joinRetries, completeAt);
+    if (par->MEMBERSHIP == MEMBERSHIP_SWIM) {
+        log->LOG(&memberNode->addr, "#STATSLOG# swim %ld msgs %ld B, %ld suspicions, %ld refutations", swimMsgs, swimBytes, suspicions, refutations);
+    }
+    else {
+        log->LOG(&memberNode->addr, "#STATSLOG# gossip full %ld msgs %ld B, delta %ld msgs %ld B", fullMsgs, fullBytes, deltaMsgs, deltaBytes);
+        if (piggyback) {
+            log->LOG(&memberNode->addr, "#STATSLOG# piggyback %ld KV msgs %ld B of deltas, %ld gossip msgs skipped", piggyMsgs, piggyBytes, gossipSkipped);
+        }
+        log->LOG(&memberNode->addr, "#STATSLOG# detector %ld removals, %ld false positives, latency mean %.1f max %ld ticks",
+                 removals, falsePositives, removals ? (double)latencySum / removals : 0.0, latencyMax);
+    }
+    if (leaveMsgs) {
+        log->LOG(&memberNode->addr, "#STATSLOG# leave %ld msgs %ld B", leaveMsgs, leaveBytes);
+    }
+}
+
+/**
+ * FUNCTION NAME: nodeLoop
+ *
+ * DESCRIPTION: Executed periodically at each member
+ * 				Check your messages in queue and perform membership protocol duties
+ */
+void MP1Node::nodeLoop() {
+    if (memberNode->bFailed) {
+    	return;
+    }
+
+    // A leaving node only hands KV messages on until it stops
+    if (memberNode->bLeaving) {
+        checkMessages();
+        if (gettime() - leaveAt > par->LEAVE_LINGER) {
+            memberNode->bFailed = true;
+        }
+        return;
+    }
+
+    // Ticks the event engine skipped, nothing but the heartbeat moved in them
+    memberNode->heartbeat += gettime() - loopedAt - 1;
+    loopedAt = gettime();
+
+    // Check my messages
+    
+    checkMessages();
+    answerJoins();
+    memberNode->heartbeat++;
+    // Wait until you're in the group...
+    if(!memberNode->inGroup ) {
+    	retryJoin();
+    	return;
+    }
+    //cout<<"node "<<memberNode->addr.getAddress()<<" sending HB at time = "<<gettime()<<" with ML size of "<<memberNode->memberList.size()<<endl;
+    //cout<<"node "<<memberNode->addr.getAddress()<<" entering node ops"<<endl;
+    // ...then jump in and share your responsibilites!
+    if (par->MEMBERSHIP == MEMBERSHIP_SWIM) swimLoopOps();
+    else nodeLoopOps();
+
+    return;
+}
+
+/**
+ * FUNCTION NAME: checkMessages
+ *
+ * DESCRIPTION: Check messages in the queue and call the respective message handler
+ */
+void MP1Node::checkMessages() {
+    void *ptr;
+    int size;
+
+    // Pop waiting messages from memberNode's mp1q
+    while ( !memberNode->mp1q.empty() ) {
+    	ptr = memberNode->mp1q.front().elt;
+    	size = memberNode->mp1q.front().size;
+    	memberNode->mp1q.pop();
+    	if ( EmulNet::ENchannel(ptr) != CH_MEMBERSHIP ) {
+    		// Handed on to the KV store, which releases it
+    		recvKV((char *)ptr, size);
+    		continue;
+    	}
+    	recvCallBack((void *)memberNode, (char *)ptr, size);
+    	emulNet->ENrelease(ptr);
+    }
+    return;
+}
+
+/**
+ * FUNCTION NAME: recvCallBack
+ *
+ * DESCRIPTION: Message handler for different message types
+ */
+void MP1Node::recvCallBack(void *env, char *data, int size ) {
+	/*
+	 * Your code goes here
+	 */
+    MsgTypes msgtype;
+    memcpy(&msgtype,data,sizeof(MsgTypes));
+    // A leaving node still follows the others that leave, its KV store hands keys to the rest
+    if (msgtype == LEAVE) {
+        recvLeave(data, size);
+    }
+    else if (memberNode->bLeaving) {
+        return;
+    }
+    else if (par->MEMBERSHIP == MEMBERSHIP_SWIM) {
+        if (msgtype == JOINREQ) swimJoinreq(data);
+        else swimRecv(msgtype, data, size);
+    }
+    else if (msgtype == JOINREQ) joinreq(data);
+    else if (msgtype == HEARTBEAT) {
+        memberNode->inGroup = true;
+        updatetables(data,size);
+    }
+    return;
+}
+/**
+* My implementation:
+This functions receives a heartbeat from another node and updates its own membership tables
+The list is in the encoding written by encodeML, messages of another version are ignored.
+*/
+void MP1Node::updatetables(char* data, int size) {
+	//cout<<"updating tables"<<endl;
+    const char *ptr = data + sizeof(MessageHdr);
+    const char *end = data + size;
+    unsigned long long id, port, heartbeat, delta;
+    if (ptr >= end || *ptr++ != HB_VERSION) {
+        return;
+    }
+    // The sender's own entry, then the others relative to the entry before them
+    if (!getVarint(ptr, end, id) || !getVarint(ptr, end, port) || !getVarint(ptr, end, heartbeat)) {
+        return;
+    }
+    mergeEntry((int)id, (short)unzigzag(port), (long)heartbeat);
+    long lastId = 0;
+    long lastHeartbeat = (long)heartbeat;
+    while (ptr < end) {
+        if (!getVarint(ptr, end, delta) || !getVarint(ptr, end, port) || !getVarint(ptr, end, heartbeat)) {
+            return;
+        }
+        lastId += (long)delta;
+        lastHeartbeat += unzigzag(heartbeat);
+        mergeEntry((int)lastId, (short)unzigzag(port), lastHeartbeat);
+    }
+    //cout<<"exiting update tables"<<endl;
+    return;
+}
+
+/**
+ * FUNCTION NAME: mergeEntry
+ *
+ * DESCRIPTION: Merge one gossiped entry into the membership list
+ */
+void MP1Node::mergeEntry(int id, short port, long heartbeat) {
+    nodekey key = packKey(id, port);
+    int slot = nodetable.find(key);
+    int removed = slot < 0 ? removedAt.find(key) : -1;
+    if (key == selfKey()){
+    	;
+    }
+    // Gossip about a removed node is ignored for TREMOVE ticks, the time it
+    // takes every copy of its entry to go stale. Heard of after that, it was alive.
+    else if (removed >= 0 && gettime() - removed <= TREMOVE * gossipStretch()) {
+    	;
+    }
+    //if new node, add it to the table
+    else if (slot < 0) {
+        if (removed >= 0) {
+            falsePositives++;
+            removedAt.erase(key);
+        }
+        addMember(id, port, heartbeat);
+    }
+    else if (heartbeat > memberNode->memberList.getheartbeat(slot)) {
+        if (par->FAILURE_DETECTOR == PHI_DETECTOR) {
+            phiRecord(slot, gettime() - memberNode->memberList.gettimestamp(slot));
+        }
+        memberNode->memberList.setheartbeat(slot, heartbeat);
+        memberNode->memberList.settimestamp(slot, gettime());
+    }
+}
+
+/**
+My implementation: 
+The response when the message is a JOINREQ
+1. add the request node into the current nodes membership list.
+2. queue it for a reply with all the other nodes in the group, see answerJoins
+*/
+void MP1Node::joinreq(char* data) {
+	//cout<<"responding to join req"<<endl;
+    char addr [6];
+    memcpy(&addr[0],data+sizeof(MessageHdr), sizeof(addr));
+    //get id, port
+    int id;
+    short port;
+    memcpy(&id, &addr[0], sizeof(int));
+	memcpy(&port, &addr[4], sizeof(short));
+    //get heartbeat
+    long heartbeat;
+    memcpy(&heartbeat,data+sizeof(MessageHdr)+sizeof(addr), sizeof(long));
+    //insert new node into memberlist, unless gossip or an earlier request got it there
+    mergeEntry(id, port, heartbeat);
+    queueJoin(packKey(id, port));
+    return;
+}
+
+/**
+ * FUNCTION NAME: queueJoin
+ *
+ * DESCRIPTION: Queue a reply to the joiner key. A joiner answered less than
+ * 				JOIN_TIMEOUT ticks ago, or already queued, has its reply in flight.
+ */
+void MP1Node::queueJoin(nodekey key) {
+    int answered = joinAnswered.find(key);
+    if (answered >= 0 && gettime() - answered < par->JOIN_TIMEOUT) {
+        return;
+    }
+    joinAnswered.set(key, gettime());
+    joinQueue.push_back(key);
+}
+
+/**
+ * FUNCTION NAME: answerJoins
+ *
+ * DESCRIPTION: Reply to every join queued this tick. The membership list is encoded
+ * 				once, in as many chunks as it takes to stay under MAX_MSG_SIZE, and
+ * 				the same chunks go to each joiner.
+ */
+void MP1Node::answerJoins() {
+    if (joinQueue.empty()) {
+        return;
+    }
+    if (par->MEMBERSHIP == MEMBERSHIP_SWIM) {
+        for (unsigned int j = 0; j < joinQueue.size(); j++) {
+            swimSendJoinList(joinQueue[j]);
+        }
+    }
+    else {
+        vector<vector<char> > chunks;
+        nodekey next = NODEKEY_EMPTY;
+        do {
+            chunks.push_back(vector<char>());
+            next = encodeML(-1, next, chunks.back(), 0);
+        } while (next != NODEKEY_EMPTY);
+        for (unsigned int j = 0; j < joinQueue.size(); j++) {
+            Address joiner = createaddress(keyId(joinQueue[j]), keyPort(joinQueue[j]));
+            for (unsigned int c = 0; c < chunks.size(); c++) {
+                emulNet->ENsend(&memberNode->addr, &joiner, &chunks[c][0], chunks[c].size());
+                fullMsgs++;
+                fullBytes += chunks[c].size();
+            }
+        }
+    }
+    joinsAnswered += joinQueue.size();
+    joinQueue.clear();
+}
+
+/**
+ * FUNCTION NAME: retryJoin
+ *
+ * DESCRIPTION: Ask the next seed once the wait for a reply is over. The wait starts at
+ * 				JOIN_TIMEOUT ticks and doubles with every retry, up to JOIN_BACKOFF_MAX times.
+ */
+void MP1Node::retryJoin() {
+    if (gettime() < joinRetryAt) {
+        return;
+    }
+    joinSeed = (joinSeed + 1) % par->INTRODUCERS.size();
+    if (par->INTRODUCERS[joinSeed] == keyId(selfKey())) {
+        joinSeed = (joinSeed + 1) % par->INTRODUCERS.size();
+    }
+    Address joinaddr = seedAddress(joinSeed);
+    joinRetries++;
+    introduceSelfToGroup(&joinaddr);
+}
+
+/* 
+My implementation:
+This function sends the membership list of the current node to another node
+as a heartbeat message type.
+The message is encoded once a tick and every peer gossiped to in that tick
+gets the same one, see encodeGossip.
+*/
+void MP1Node::sendML(Address * addr) {
+    if (hbCacheTime != gettime()) {
+        encodeGossip();
+        hbCacheTime = gettime();
+    }
+    //cout<<"memberlist size = "<<memberNode->memberList.size()<<", messagesize = "<<msgsize<<endl;
+    emulNet->ENsend(&memberNode->addr, addr, &hbCache[0], hbCache.size());
+    if (gossipSync.since < 0) {
+        fullMsgs++;
+        fullBytes += hbCache.size();
+    }
+    else {
+        deltaMsgs++;
+        deltaBytes += hbCache.size();
+    }
+    //cout<<"send completed"<<endl;
+    return;
+}
+
+/**
+ * FUNCTION NAME: encodeGossip
+ *
+ * DESCRIPTION: Encode the next gossip message into hbCache. When the last list went
+ * 				out to the end a new one starts: the full list, or in delta mode only
+ * 				the entries refreshed since the list before the last one started, as
+ * 				long as the last full list started less than FULL_SYNC_PERIOD ticks
+ * 				ago. A refresh so goes out in two rounds: pushed in only one, an entry
+ * 				missed about half the ticks at 300 nodes and went TREMOVE ticks
+ * 				unrefreshed now and then. A list that does not fit under MAX_MSG_SIZE
+ * 				is sent in chunks over the next rounds, each starting where the
+ * 				previous one stopped, so a full list only counts as sent, and deltas
+ * 				only start from it, once the rotation has covered it all.
+ */
+void MP1Node::encodeGossip() {
+    gossip_sync &sync = gossipSync;
+    if (sync.cursor == NODEKEY_EMPTY) {
+        bool full = par->GOSSIP_MODE == GOSSIP_FULL || sync.full < 0 || gettime() - sync.full >= par->FULL_SYNC_PERIOD;
+        sync.start = gettime();
+        sync.since = full ? -1 : sync.before;
+    }
+    sync.cursor = encodeML(sync.since, sync.cursor, hbCache, 0);
+    if (sync.cursor == NODEKEY_EMPTY) {
+        if (sync.since < 0) {
+            sync.full = sync.start;
+        }
+        sync.before = sync.sent;
+        sync.sent = sync.start;
+    }
+}
+
+/**
+ * FUNCTION NAME: setPiggyback
+ *
+ * DESCRIPTION: Let the KV store send its messages through this node, carrying
+ * 				membership deltas, with no gossip to a peer for quiet ticks after one
+ */
+void MP1Node::setPiggyback(int quiet) {
+    piggyback = true;
+    piggybackQuiet = quiet;
+}
+
+/**
+ * FUNCTION NAME: sendKV
+ *
+ * DESCRIPTION: Send a KV store message kv to addr, with piggybacking on. A peer that
+ * 				got a complete delta in the last piggybackQuiet ticks gets kv as it is,
+ * 				on CH_KV, and no gossip either. Otherwise kv goes on CH_KV_DELTA behind
+ * 				a heartbeat message with this node's entry and the entries refreshed
+ * 				since the last complete delta to that peer, or in the last
+ * 				piggybackQuiet ticks for a first contact, and ends with the size of
+ * 				kv in two bytes. kv too big to leave room for two entries goes alone.
+ */
+void MP1Node::sendKV(Address *addr, string kv) {
+    int peerId;
+    short peerPort;
+    memcpy(&peerId, &addr->addr[0], sizeof(int));
+    memcpy(&peerPort, &addr->addr[4], sizeof(short));
+    nodekey peer = packKey(peerId, peerPort);
+    int since = lastPiggyback.find(peer);
+    // Nobody takes this node's entry any more once it announced its leave
+    if (memberNode->bLeaving || (since >= 0 && gettime() - since < piggybackQuiet)) {
+        emulNet->ENsend(&memberNode->addr, addr, (char *)kv.data(), kv.size(), CH_KV);
+        return;
+    }
+    unsigned short kvSize = kv.size();
+    int reserve = kv.size() + sizeof(kvSize);
+    // encodeML always writes the self entry and one more
+    if ((int)sizeof(MessageHdr) + 1 + 2 * HB_MAX_ENTRY + reserve > par->MAX_MSG_SIZE - 1 - (int)sizeof(en_msg)) {
+        emulNet->ENsend(&memberNode->addr, addr, (char *)kv.data(), kv.size(), CH_KV);
+        return;
+    }
+    if (since < 0) {
+        since = gettime() - piggybackQuiet;
+    }
+    vector<char> msg;
+    if (encodeML(since, NODEKEY_EMPTY, msg, reserve) == NODEKEY_EMPTY) {
+        lastPiggyback.set(peer, gettime());
+    }
+    piggyMsgs++;
+    piggyBytes += msg.size() + sizeof(kvSize);
+    msg.insert(msg.end(), kv.begin(), kv.end());
+    msg.insert(msg.end(), (char *)&kvSize, (char *)(&kvSize + 1));
+    emulNet->ENsend(&memberNode->addr, addr, &msg[0], msg.size(), CH_KV_DELTA);
+}
+
+/**
+ * FUNCTION NAME: recvKV
+ *
+ * DESCRIPTION: Merge the membership delta in front of a CH_KV_DELTA message, then
+ * 				queue the message for the KV store, see kvPayload
+ */
+void MP1Node::recvKV(char *data, int size) {
+    if (EmulNet::ENchannel(data) == CH_KV_DELTA) {
+        unsigned short kvSize;
+        memcpy(&kvSize, data + size - sizeof(kvSize), sizeof(kvSize));
+        if (kvSize > size - (int)sizeof(kvSize)) {
+            emulNet->ENrelease(data);
+            return;
+        }
+        updatetables(data, size - sizeof(kvSize) - kvSize);
+    }
+    Queue::enqueue(&memberNode->mp2q, data, size);
+}
+
+/**
+ * FUNCTION NAME: kvPayload
+ *
+ * DESCRIPTION: The KV store message in a message of size bytes received with
+ * 				piggybacking on. size becomes its size.
+ */
+char *MP1Node::kvPayload(char *data, int &size) {
+    if (EmulNet::ENchannel(data) != CH_KV_DELTA) {
+        return data;
+    }
+    unsigned short kvSize;
+    memcpy(&kvSize, data + size - sizeof(kvSize), sizeof(kvSize));
+    char *kv = data + size - sizeof(kvSize) - kvSize;
+    size = kvSize;
+    return kv;
+}
+
+/**
+ * FUNCTION NAME: sendLeave
+ *
+ * DESCRIPTION: Send a LEAVE for nodes to the node to, each one as the varints of its
+ * 				id and zigzag port
+ */
+void MP1Node::sendLeave(nodekey to, vector<nodekey> &nodes) {
+    MessageHdr hdr;
+    hdr.msgType = LEAVE;
+    vector<char> msg((char *)&hdr, (char *)(&hdr + 1));
+    for (unsigned int i = 0; i < nodes.size(); i++) {
+        putVarint(msg, (unsigned int)keyId(nodes[i]));
+        putVarint(msg, zigzag(keyPort(nodes[i])));
+    }
+    Address toaddr = createaddress(keyId(to), keyPort(to));
+    emulNet->ENsend(&memberNode->addr, &toaddr, &msg[0], msg.size());
+    leaveMsgs++;
+    leaveBytes += msg.size();
+}
+
+/**
+ * FUNCTION NAME: recvLeave
+ *
+ * DESCRIPTION: Drop the nodes of a LEAVE from the membership list. With gossip a node
+ * 				dropped here is forwarded in the next rounds, see forwardLeaves, and
+ * 				ignored for TREMOVE ticks like a removed one. With SWIM the leave is
+ * 				applied as a confirm, which is final and spreads with the SWIM updates.
+ */
+void MP1Node::recvLeave(char *data, int size) {
+    const char *ptr = data + sizeof(MessageHdr);
+    const char *end = data + size;
+    unsigned long long id, port;
+    while (ptr < end) {
+        if (!getVarint(ptr, end, id) || !getVarint(ptr, end, port)) {
+            return;
+        }
+        nodekey key = packKey((int)id, (short)unzigzag(port));
+        if (key == selfKey()) {
+            continue;
+        }
+        int slot = nodetable.find(key);
+        if (par->MEMBERSHIP == MEMBERSHIP_SWIM) {
+            swimApply(key, SWIM_CONFIRM, slot >= 0 ? memberNode->memberList.getheartbeat(slot) : 0);
+            continue;
+        }
+        removedAt.set(key, gettime());
+        if (slot >= 0) {
+            removeMember(slot);
+            leave_rumor rumor;
+            rumor.node = key;
+            rumor.sent = 0;
+            leaves.push_back(rumor);
+        }
+    }
+}
+
+/**
+ * FUNCTION NAME: forwardLeaves
+ *
+ * DESCRIPTION: Send the leaves heard lately to the peers of this gossip round. The
+ * 				leaving node told every member it knew, so this only covers lost
+ * 				messages and members it did not know: a leave is forwarded for
+ * 				log2 of the group size rounds, then retired.
+ */
+void MP1Node::forwardLeaves(vector<nodekey> &peers) {
+    if (leaves.empty()) {
+        return;
+    }
+    vector<nodekey> nodes;
+    for (unsigned int i = 0; i < leaves.size(); i++) {
+        nodes.push_back(leaves[i].node);
+    }
+    for (unsigned int i = 0; i < peers.size(); i++) {
+        sendLeave(peers[i], nodes);
+    }
+    int rounds = 1;
+    for (unsigned int n = memberNode->memberList.size() + 1; n > 1; n >>= 1) {
+        rounds++;
+    }
+    for (unsigned int i = 0; i < leaves.size(); ) {
+        if (++leaves[i].sent >= rounds) {
+            leaves[i] = leaves.back();
+            leaves.pop_back();
+        }
+        else {
+            i++;
+        }
+    }
+}
+
+/**
+ * FUNCTION NAME: encodeML
+ *
+ * DESCRIPTION: Write a heartbeat message into msg: the HB_VERSION byte, this node's own
+ * 				entry, then the entries refreshed within TFAIL ticks and after since,
+ * 				in key order starting at key from. An id is written as the difference
+ * 				to the previous id, a heartbeat as the zigzag difference to the previous
+ * 				heartbeat, everything as varints. Stops before going over MAX_MSG_SIZE,
+ * 				less reserve bytes the caller appends.
+ *
+ * RETURNS:
+ * key of the first entry left out, NODEKEY_EMPTY if every entry went in
+ */
+nodekey MP1Node::encodeML(long since, nodekey from, vector<char> &msg, int reserve) {
+    MemberTable &table = memberNode->memberList;
+    vector<int> entries;
+    int tfail = TFAIL * gossipStretch();
+    unsigned int first = lower_bound(sortedKeys.begin(), sortedKeys.end(), from == NODEKEY_EMPTY ? 0 : from) - sortedKeys.begin();
+    unsigned int skipped = 0;
+    table.markFresh(gettime() - tfail, since, fresh);
+    for (unsigned int k = 0; k < sortedKeys.size(); k++) {
+        int i = nodetable.find(sortedKeys[k]);
+        if (fresh[i]) {
+            entries.push_back(i);
+        }
+        else if (k < first) {
+            skipped++;
+        }
+    }
+    first -= skipped;
+
+    MessageHdr hdr;
+    hdr.msgType = HEARTBEAT;
+    msg.assign((char *)&hdr, (char *)(&hdr + 1));
+    msg.push_back(HB_VERSION);
+    putVarint(msg, (unsigned int)keyId(selfKey()));
+    putVarint(msg, zigzag(keyPort(selfKey())));
+    putVarint(msg, memberNode->heartbeat);
+
+    int budget = par->MAX_MSG_SIZE - 1 - (int)sizeof(en_msg) - reserve;
+    long lastId = 0;
+    long lastHeartbeat = memberNode->heartbeat;
+    for (unsigned int n = first; n < entries.size(); n++) {
+        if (n > first && (int)msg.size() + HB_MAX_ENTRY > budget) {
+            gossipChunkRoom = n - first;
+            return table.getkey(entries[n]);
+        }
+        nodekey key = table.getkey(entries[n]);
+        long heartbeat = table.getheartbeat(entries[n]);
+        putVarint(msg, keyId(key) - lastId);
+        putVarint(msg, zigzag(keyPort(key)));
+        putVarint(msg, zigzag(heartbeat - lastHeartbeat));
+        lastId = keyId(key);
+        lastHeartbeat = heartbeat;
+    }
+    return NODEKEY_EMPTY;
+}
+
+/**
+ * My implementation
+ * FUNCTION NAME: nodeLoopOps
+ *
+ * DESCRIPTION: Check if any node hasn't responded within a timeout period and then delete
+ * 				the nodes
+ * 				Propagate your membership list
+ * 				Only members whose deadline is due are looked at. A refreshed member
+ * 				gets its new deadline pushed back then, instead of on every heartbeat.
+ * 				Entries left over from a member removed, and maybe added again since,
+ * 				are dropped.
+ */
+void MP1Node::nodeLoopOps() {
+    while (!expiries.empty() && expiries.top().deadline <= gettime()) {
+        member_expiry expiry = expiries.top();
+        expiries.pop();
+        if (expiryAt.find(expiry.node) != expiry.deadline) {
+            continue;
+        }
+        int i = nodetable.find(expiry.node);
+        expiry.deadline = expireAt(i);
+        if (expiry.deadline > gettime()) {
+            expiryAt.set(expiry.node, expiry.deadline);
+            expiries.push(expiry);
+            continue;
+        }
+        long silent = gettime() - memberNode->memberList.gettimestamp(i);
+        removals++;
+        latencySum += silent;
+        latencyMax = max(latencyMax, silent);
+        removedAt.set(expiry.node, gettime());
+        removeMember(i);
+    }
+    if (gettime() < nextGossip) {
+        return;
+    }
+    int size = memberNode->memberList.size();
+    int fanout = par->GOSSIP_FANOUT;
+    if (par->GOSSIP_ADAPTIVE) {
+        fanout = max(1, (int)ceil(::log(size + 1.0)));
+        // Back off while nothing joined or left since the last round, start over on a change
+        gossipInterval = lastChange >= lastGossip ? 1 : min(2 * gossipInterval, par->GOSSIP_INTERVAL);
+    }
+    lastGossip = gettime();
+    nextGossip = gettime() + gossipInterval;
+    //pick fanout distinct random nodes and send a heartbeat
+    vector<int> picked;
+    vector<nodekey> peers;
+    while ((int)picked.size() < min(fanout, size)) {
+        int node = rand() % size;
+        if (find(picked.begin(), picked.end(), node) == picked.end()) {
+            picked.push_back(node);
+            peers.push_back(memberNode->memberList.getkey(node));
+            // A KV message just brought the peer every recent change
+            int piggybacked = lastPiggyback.find(memberNode->memberList.getkey(node));
+            if (piggybacked >= 0 && gettime() - piggybacked < piggybackQuiet) {
+                gossipSkipped++;
+                continue;
+            }
+            Address addr = createaddress(memberNode->memberList.getid(node), memberNode->memberList.getport(node));
+            sendML(&addr);
+        }
+    }
+    forwardLeaves(peers);
+    return;
+}
+Address MP1Node::createaddress(int id, short port) {
+    return Address(id, port);
+}
+
+/**
+ * FUNCTION NAME: gossipChunks
+ *
+ * DESCRIPTION: Number of ticks it takes the full list gossip to cover the membership
+ * 				list, at the number of entries the last chunk held. An entry is refreshed
+ * 				that many times less often once the list goes out in chunks, so TFAIL
+ * 				and TREMOVE are stretched by as much.
+ */
+int MP1Node::gossipChunks() {
+    return max(1, ((int)memberNode->memberList.size() + gossipChunkRoom - 1) / gossipChunkRoom);
+}
+
+/**
+ * FUNCTION NAME: gossipStretch
+ *
+ * DESCRIPTION: How many times longer than with one full list per tick an entry can
+ * 				go without a refresh, gossipChunks() times the longest gossip interval.
+ * 				TFAIL and TREMOVE are stretched by as much.
+ */
+int MP1Node::gossipStretch() {
+    return gossipChunks() * par->GOSSIP_INTERVAL;
+}
+
+/**
+ * FUNCTION NAME: getGossipBytes
+ *
+ * DESCRIPTION: Bytes of membership traffic this node sent
+ */
+long MP1Node::getGossipBytes() {
+    return fullBytes + deltaBytes + swimBytes + piggyBytes + leaveBytes;
+}
+
+/**
+ * FUNCTION NAME: getLastChange
+ *
+ * DESCRIPTION: Last tick a node was added to or removed from this node's list
+ */
+int MP1Node::getLastChange() {
+    return lastChange;
+}
+
+/**
+ * FUNCTION NAME: nextWake
+ *
+ * DESCRIPTION: Earliest tick after this one at which nodeLoop has more to do than
+ * 				count the heartbeat, unless a message comes in first: the next join
+ * 				retry, gossip round, expiry, SWIM probe step, suspicion or relay
+ * 				timeout, or the end of a leave. INT_MAX if nothing is due.
+ */
+int MP1Node::nextWake() {
+    int now = gettime();
+    int wake = INT_MAX;
+    if (memberNode->bFailed) {
+        return wake;
+    }
+    if (memberNode->bLeaving) {
+        return leaveAt + par->LEAVE_LINGER + 1;
+    }
+    if (!memberNode->inGroup) {
+        return max(now + 1, joinRetryAt);
+    }
+    if (par->MEMBERSHIP != MEMBERSHIP_SWIM) {
+        wake = nextGossip;
+        if (!expiries.empty()) {
+            wake = min(wake, expiries.top().deadline);
+        }
+        return max(now + 1, wake);
+    }
+    // swimLoopOps only leaves no probe running when there is nobody to probe
+    if (probeTarget != NODEKEY_EMPTY) {
+        if (!probeAcked && !probeIndirect) {
+            wake = probeStart + par->PING_TIMEOUT;
+        }
+        wake = min(wake, probeStart + 3 * par->PING_TIMEOUT);
+    }
+    int suspectTimeout = par->SUSPECT_TIMEOUT;
+    if (suspectTimeout <= 0) {
+        suspectTimeout = swimRounds() * 3 * par->PING_TIMEOUT;
+    }
+    for (int i = 0; i < (int)memberNode->memberList.size(); i++) {
+        int since = suspectAt.find(memberNode->memberList.getkey(i));
+        if (since >= 0) {
+            wake = min(wake, since + suspectTimeout + 1);
+        }
+    }
+    for (unsigned int i = 0; i < relays.size(); i++) {
+        wake = min(wake, relays[i].expires + 1);
+    }
+    return max(now + 1, wake);
+}
+
+/**
+ * FUNCTION NAME: getCompleteAt
+ *
+ * DESCRIPTION: Tick this node first had every other node of the run in its list,
+ * 				-1 if it never did
+ */
+int MP1Node::getCompleteAt() {
+    return completeAt;
+}
+
+/**
+ * FUNCTION NAME: addMember
+ *
+ * DESCRIPTION: Log a new node and append it to the membership list
+ *
+ * RETURNS:
+ * its slot in the membership list
+ */
+int MP1Node::addMember(int id, short port, long heartbeat) {
+    Address tempaddr = createaddress(id, port);
+    int slot = memberNode->memberList.size();
+    log->logNodeAdd(&memberNode->addr, &tempaddr);
+    nodetable.set(packKey(id, port), slot);
+    sortedKeys.insert(upper_bound(sortedKeys.begin(), sortedKeys.end(), packKey(id, port)), packKey(id, port));
+    lastChange = gettime();
+    publishEvent(MEMBER_JOINED, id, port);
+    memberNode->memberList.add(id, port, heartbeat, gettime());
+    if (completeAt < 0 && (int)memberNode->memberList.size() == par->EN_GPSZ - 1) {
+        completeAt = gettime();
+    }
+    if (par->FAILURE_DETECTOR == PHI_DETECTOR) {
+        arrivals.push_back(phi_window());
+        memset(&arrivals.back(), 0, sizeof(phi_window));
+    }
+    if (par->MEMBERSHIP == MEMBERSHIP_GOSSIP) {
+        member_expiry expiry;
+        expiry.deadline = expireAt(slot);
+        expiry.node = packKey(id, port);
+        expiryAt.set(expiry.node, expiry.deadline);
+        expiries.push(expiry);
+    }
+    return slot;
+}
+
+/**
+ * FUNCTION NAME: removeMember
+ *
+ * DESCRIPTION: Log the removal of the node in slot and drop it from the membership
+ * 				list. The last entry moves into slot.
+ */
+void MP1Node::removeMember(int slot) {
+    int id = memberNode->memberList.getid(slot);
+    short port = memberNode->memberList.getport(slot);
+    Address tempaddr = createaddress(id, port);
+    log->logNodeRemove(&memberNode->addr, &tempaddr);
+    nodetable.erase(packKey(id, port));
+    suspectAt.erase(packKey(id, port));
+    expiryAt.erase(packKey(id, port));
+    sortedKeys.erase(lower_bound(sortedKeys.begin(), sortedKeys.end(), packKey(id, port)));
+    lastChange = gettime();
+    publishEvent(MEMBER_LEFT, id, port);
+    memberNode->memberList.remove(slot);
+    if (par->FAILURE_DETECTOR == PHI_DETECTOR) {
+        arrivals[slot] = arrivals.back();
+        arrivals.pop_back();
+    }
+    // The last entry moved into slot, unless it was the one removed
+    if (slot < (int)memberNode->memberList.size()) {
+        nodetable.set(memberNode->memberList.getkey(slot), slot);
+    }
+}
+
+/**
+ * FUNCTION NAME: publishEvent
+ *
+ * DESCRIPTION: Advance the membership epoch and queue the change for the consumer
+ * 				of the membership list, if there is one
+ */
+void MP1Node::publishEvent(int type, int id, short port) {
+    memberNode->epoch++;
+    if (memberNode->watchEvents) {
+        memberNode->events.push(MemberEvent(type, id, port, memberNode->epoch));
+    }
+}
+
+/**
+ * FUNCTION NAME: phiRecord
+ *
+ * DESCRIPTION: Add a heartbeat inter-arrival time to the window of the member in
+ * 				slot. Heartbeats arriving in the same tick count as one arrival.
+ */
+void MP1Node::phiRecord(int slot, int interval) {
+    phi_window &w = arrivals[slot];
+    if (interval <= 0) {
+        return;
+    }
+    if (w.count == PHI_WINDOW) {
+        w.sum -= w.intervals[w.next];
+        w.sumsq -= (long)w.intervals[w.next] * w.intervals[w.next];
+    }
+    else {
+        w.count++;
+    }
+    w.intervals[w.next] = interval;
+    w.sum += interval;
+    w.sumsq += (long)interval * interval;
+    w.next = (w.next + 1) % PHI_WINDOW;
+}
+
+/**
+ * FUNCTION NAME: phi
+ *
+ * DESCRIPTION: Suspicion level of the member in slot, -log10 of the probability
+ * 				that a heartbeat still comes this late given a normal distribution of
+ * 				its past inter-arrival times. Uses the logistic approximation of the
+ * 				normal CDF so the tail does not round to 1.
+ */
+double MP1Node::phi(int slot, long silent) {
+    phi_window &w = arrivals[slot];
+    double mean = (double)w.sum / w.count;
+    double stddev = sqrt(max(0.0, (double)w.sumsq / w.count - mean * mean));
+    stddev = max(stddev, PHI_MIN_STDDEV);
+    double y = (silent - mean) / stddev;
+    double e = exp(-y * (1.5976 + 0.070566 * y * y));
+    if (y > 0) {
+        return -log10(e / (1.0 + e));
+    }
+    return -log10(1.0 - 1.0 / (1.0 + e));
+}
+
+/**
+ * FUNCTION NAME: expireAt
+ *
+ * DESCRIPTION: Tick the member in slot is removed at if no heartbeat refreshes it,
+ * 				the first one more than TREMOVE ticks (times gossipStretch()) after its timestamp, or the first
+ * 				one its phi exceeds PHI_THRESHOLD at. phi grows with the time since the
+ * 				last heartbeat, so the latter is found by binary search.
+ */
+int MP1Node::expireAt(int slot) {
+    long timestamp = memberNode->memberList.gettimestamp(slot);
+    if (par->FAILURE_DETECTOR != PHI_DETECTOR || arrivals[slot].count < PHI_MIN_SAMPLES) {
+        return timestamp + TREMOVE * gossipStretch() + 1;
+    }
+    long lo = 0, hi = 1;
+    while (phi(slot, hi) <= par->PHI_THRESHOLD && hi < (1L << 20)) {
+        lo = hi;
+        hi *= 2;
+    }
+    // phi(lo) is at most the threshold, phi(hi) above it
+    while (hi - lo > 1) {
+        long mid = (lo + hi) / 2;
+        if (phi(slot, mid) > par->PHI_THRESHOLD) hi = mid;
+        else lo = mid;
+    }
+    return timestamp + hi;
+}
+
+/**
+ * FUNCTION NAME: swimLoopOps
+ *
+ * DESCRIPTION: One tick of the SWIM protocol. A protocol period lasts three
+ * 				PING_TIMEOUTs: a PING to the next member in the probe order, PINGREQs
+ * 				to PINGREQ_K others if no ACK came back within PING_TIMEOUT, and the
+ * 				target is suspected if still no ACK came back by the end of the period.
+ * 				Suspects that did not refute within SUSPECT_TIMEOUT are confirmed dead.
+ */
+void MP1Node::swimLoopOps() {
+    int now = gettime();
+    int suspectTimeout = par->SUSPECT_TIMEOUT;
+    if (suspectTimeout <= 0) {
+        suspectTimeout = swimRounds() * 3 * par->PING_TIMEOUT;
+    }
+
+    if (probeTarget != NODEKEY_EMPTY) {
+        if (!probeAcked && !probeIndirect && now - probeStart >= par->PING_TIMEOUT) {
+            swimPingReq();
+            probeIndirect = true;
+        }
+        if (now - probeStart >= 3 * par->PING_TIMEOUT) {
+            int slot = nodetable.find(probeTarget);
+            if (!probeAcked && slot >= 0 && !suspectAt.contains(probeTarget)) {
+                suspicions++;
+                swimApply(probeTarget, SWIM_SUSPECT, memberNode->memberList.getheartbeat(slot));
+            }
+            probeTarget = NODEKEY_EMPTY;
+        }
+    }
+
+    for (int i = 0; i < (int)memberNode->memberList.size(); i++) {
+        nodekey key = memberNode->memberList.getkey(i);
+        int since = suspectAt.find(key);
+        if (since >= 0 && now - since > suspectTimeout) {
+            // swimApply removes slot i, the last entry takes its place
+            swimApply(key, SWIM_CONFIRM, memberNode->memberList.getheartbeat(i));
+            i--;
+        }
+    }
+
+    for (unsigned int i = 0; i < relays.size(); i++) {
+        if (relays[i].expires < now) {
+            relays[i] = relays.back();
+            relays.pop_back();
+            i--;
+        }
+    }
+
+    if (probeTarget == NODEKEY_EMPTY) {
+        probeTarget = swimNextTarget();
+        if (probeTarget != NODEKEY_EMPTY) {
+            probeSeq = nextSeq++;
+            probeStart = now;
+            probeAcked = false;
+            probeIndirect = false;
+            swimSend(PING, probeSeq, probeTarget, probeTarget);
+        }
+    }
+}
+
+/**
+ * FUNCTION NAME: swimNextTarget
+ *
+ * DESCRIPTION: Next member to probe. Members are probed in a random order that is
+ * 				reshuffled after every pass, so each one is probed once per pass.
+ *
+ * RETURNS:
+ * its key, NODEKEY_EMPTY if there is no other member
+ */
+nodekey MP1Node::swimNextTarget() {
+    for (int pass = 0; pass < 2; pass++) {
+        while (probeNext < probeOrder.size()) {
+            nodekey key = probeOrder[probeNext++];
+            if (nodetable.contains(key)) {
+                return key;
+            }
+        }
+        probeOrder.clear();
+        for (int i = 0; i < memberNode->memberList.size(); i++) {
+            probeOrder.push_back(memberNode->memberList.getkey(i));
+        }
+        for (int i = (int)probeOrder.size() - 1; i > 0; i--) {
+            swap(probeOrder[i], probeOrder[rand() % (i + 1)]);
+        }
+        probeNext = 0;
+    }
+    return NODEKEY_EMPTY;
+}
+
+/**
+ * FUNCTION NAME: swimPingReq
+ *
+ * DESCRIPTION: Ask up to PINGREQ_K random members other than the probe target to
+ * 				ping it on this node's behalf
+ */
+void MP1Node::swimPingReq() {
+    vector<int> helpers;
+    for (int i = 0; i < (int)memberNode->memberList.size(); i++) {
+        if (memberNode->memberList.getkey(i) != probeTarget) {
+            helpers.push_back(i);
+        }
+    }
+    for (int k = 0; k < par->PINGREQ_K && k < (int)helpers.size(); k++) {
+        swap(helpers[k], helpers[k + rand() % (helpers.size() - k)]);
+        swimSend(PINGREQ, probeSeq, memberNode->memberList.getkey(helpers[k]), probeTarget);
+    }
+}
+
+/**
+ * FUNCTION NAME: swimRecv
+ *
+ * DESCRIPTION: Handle a PING, PINGREQ, ACK or JOINREP. The sender is known alive at
+ * 				the incarnation it sent, then the piggybacked updates are applied.
+ */
+void MP1Node::swimRecv(MsgTypes msgtype, char *data, int size) {
+    SwimHdr hdr;
+    SwimUpdate update;
+    int id;
+    short port;
+
+    if (size < (int)(sizeof(MessageHdr) + sizeof(SwimHdr))) {
+        return;
+    }
+    memcpy(&hdr, data + sizeof(MessageHdr), sizeof(SwimHdr));
+    memberNode->inGroup = true;
+
+    memcpy(&id, &hdr.from[0], sizeof(int));
+    memcpy(&port, &hdr.from[4], sizeof(short));
+    nodekey from = packKey(id, port);
+    memcpy(&id, &hdr.target[0], sizeof(int));
+    memcpy(&port, &hdr.target[4], sizeof(short));
+    nodekey target = packKey(id, port);
+
+    swimApply(from, SWIM_ALIVE, hdr.incarnation);
+    char *ptr = data + sizeof(MessageHdr) + sizeof(SwimHdr);
+    for (int i = 0; i < hdr.count && ptr + sizeof(SwimUpdate) <= data + size; i++) {
+        memcpy(&update, ptr, sizeof(SwimUpdate));
+        memcpy(&id, &update.addr[0], sizeof(int));
+        memcpy(&port, &update.addr[4], sizeof(short));
+        swimApply(packKey(id, port), update.state, update.incarnation);
+        ptr += sizeof(SwimUpdate);
+    }
+
+    if (msgtype == PING) {
+        swimSend(ACK, hdr.seq, from, selfKey());
+    }
+    else if (msgtype == PINGREQ) {
+        swim_relay relay;
+        relay.seq = nextSeq++;
+        relay.target = target;
+        relay.requester = from;
+        relay.reqSeq = hdr.seq;
+        relay.expires = gettime() + 2 * par->PING_TIMEOUT;
+        relays.push_back(relay);
+        swimSend(PING, relay.seq, target, target);
+    }
+    else if (msgtype == ACK) {
+        if (target == probeTarget && hdr.seq == probeSeq) {
+            probeAcked = true;
+        }
+        for (unsigned int i = 0; i < relays.size(); i++) {
+            if (relays[i].seq == hdr.seq && relays[i].target == target) {
+                swimSend(ACK, relays[i].reqSeq, relays[i].requester, target);
+                relays[i] = relays.back();
+                relays.pop_back();
+                break;
+            }
+        }
+    }
+}
+
+/**
+ * FUNCTION NAME: swimApply
+ *
+ * DESCRIPTION: Apply a membership update and queue it for dissemination if it
+ * 				changed anything. A higher incarnation overrides, at the same one
+ * 				suspect overrides alive, confirm overrides everything and is final.
+ * 				A suspicion of this node is refuted with a higher incarnation.
+ */
+void MP1Node::swimApply(nodekey key, int state, long incarnation) {
+    if (key == selfKey()) {
+        if (state != SWIM_ALIVE && incarnation >= this->incarnation) {
+            this->incarnation = incarnation + 1;
+            refutations++;
+            swimAddRumor(key, SWIM_ALIVE, this->incarnation);
+        }
+        return;
+    }
+    if (confirmed.contains(key)) {
+        return;
+    }
+
+    int slot = nodetable.find(key);
+    if (state == SWIM_CONFIRM) {
+        if (slot >= 0) {
+            removeMember(slot);
+        }
+        confirmed.set(key, (int)incarnation);
+        swimAddRumor(key, state, incarnation);
+        return;
+    }
+    if (slot < 0) {
+        slot = addMember(keyId(key), keyPort(key), incarnation);
+        if (state == SWIM_SUSPECT) {
+            suspectAt.set(key, gettime());
+        }
+        swimAddRumor(key, state, incarnation);
+        return;
+    }
+
+    long heartbeat = memberNode->memberList.getheartbeat(slot);
+    bool suspected = suspectAt.contains(key);
+    if (state == SWIM_ALIVE && incarnation > heartbeat) {
+        suspectAt.erase(key);
+    }
+    else if (state == SWIM_SUSPECT && (incarnation > heartbeat || (incarnation == heartbeat && !suspected))) {
+        suspectAt.set(key, gettime());
+    }
+    else {
+        return;
+    }
+    memberNode->memberList.setheartbeat(slot, incarnation);
+    memberNode->memberList.settimestamp(slot, gettime());
+    swimAddRumor(key, state, incarnation);
+}
+
+/**
+ * FUNCTION NAME: swimJoinreq
+ *
+ * DESCRIPTION: Introducer side of a SWIM join. The new node is announced as alive
+ * 				and gets the whole membership in JOINREPs, see answerJoins.
+ */
+void MP1Node::swimJoinreq(char *data) {
+    int id;
+    short port;
+    memcpy(&id, data + sizeof(MessageHdr), sizeof(int));
+    memcpy(&port, data + sizeof(MessageHdr) + sizeof(int), sizeof(short));
+    nodekey key = packKey(id, port);
+    swimApply(key, SWIM_ALIVE, 0);
+    queueJoin(key);
+}
+
+/**
+ * FUNCTION NAME: swimSendJoinList
+ *
+ * DESCRIPTION: Send JOINREPs carrying every member this node knows, with its state,
+ * 				as many as it takes to stay under MAX_MSG_SIZE
+ */
+void MP1Node::swimSendJoinList(nodekey to) {
+    int total = memberNode->memberList.size();
+    int room = (par->MAX_MSG_SIZE - 1 - (int)sizeof(en_msg) - (int)sizeof(MessageHdr) - (int)sizeof(SwimHdr)) / (int)sizeof(SwimUpdate);
+    char *msg = (char *) malloc(par->MAX_MSG_SIZE * sizeof(char));
+    Address toaddr = createaddress(keyId(to), keyPort(to));
+    SwimHdr hdr;
+    SwimUpdate update;
+
+    ((MessageHdr *)msg)->msgType = JOINREP;
+    memset(&hdr, 0, sizeof(SwimHdr));
+    memcpy(hdr.from, memberNode->addr.addr, sizeof(hdr.from));
+    memcpy(hdr.target, hdr.from, sizeof(hdr.target));
+    hdr.incarnation = incarnation;
+    for (int first = 0; first < total; first += room) {
+        hdr.count = min(room, total - first);
+        memcpy(msg + sizeof(MessageHdr), &hdr, sizeof(SwimHdr));
+        for (int i = 0; i < hdr.count; i++) {
+            nodekey key = memberNode->memberList.getkey(first + i);
+            int id = keyId(key);
+            short port = keyPort(key);
+            memset(&update, 0, sizeof(SwimUpdate));
+            memcpy(&update.addr[0], &id, sizeof(int));
+            memcpy(&update.addr[4], &port, sizeof(short));
+            update.state = suspectAt.contains(key) ? SWIM_SUSPECT : SWIM_ALIVE;
+            update.incarnation = memberNode->memberList.getheartbeat(first + i);
+            memcpy(msg + sizeof(MessageHdr) + sizeof(SwimHdr) + i * sizeof(SwimUpdate), &update, sizeof(SwimUpdate));
+        }
+
+        size_t msgsize = sizeof(MessageHdr) + sizeof(SwimHdr) + hdr.count * sizeof(SwimUpdate);
+        emulNet->ENsend(&memberNode->addr, &toaddr, msg, msgsize);
+        swimMsgs++;
+        swimBytes += msgsize;
+    }
+    free(msg);
+}
+
+/**
+ * FUNCTION NAME: swimSend
+ *
+ * DESCRIPTION: Send a PING, PINGREQ or ACK with up to PIGGYBACK_MAX updates, so the
+ * 				size of a message does not depend on the size of the group
+ */
+void MP1Node::swimSend(MsgTypes msgtype, int seq, nodekey to, nodekey target) {
+    char msg[sizeof(MessageHdr) + sizeof(SwimHdr) + 64 * sizeof(SwimUpdate)];
+    SwimHdr hdr;
+    int id = keyId(target);
+    short port = keyPort(target);
+
+    ((MessageHdr *)msg)->msgType = msgtype;
+    memset(&hdr, 0, sizeof(SwimHdr));
+    hdr.seq = seq;
+    memcpy(hdr.from, memberNode->addr.addr, sizeof(hdr.from));
+    memcpy(&hdr.target[0], &id, sizeof(int));
+    memcpy(&hdr.target[4], &port, sizeof(short));
+    hdr.incarnation = incarnation;
+    hdr.count = swimPiggyback(to, (SwimUpdate *)(msg + sizeof(MessageHdr) + sizeof(SwimHdr)), min(par->PIGGYBACK_MAX, 64));
+    memcpy(msg + sizeof(MessageHdr), &hdr, sizeof(SwimHdr));
+
+    size_t msgsize = sizeof(MessageHdr) + sizeof(SwimHdr) + hdr.count * sizeof(SwimUpdate);
+    Address toaddr = createaddress(keyId(to), keyPort(to));
+    emulNet->ENsend(&memberNode->addr, &toaddr, msg, msgsize);
+    swimMsgs++;
+    swimBytes += msgsize;
+}
+
+/**
+ * FUNCTION NAME: swimAddRumor
+ *
+ * DESCRIPTION: Queue an update for dissemination, replacing any older one about
+ * 				the same node
+ */
+void MP1Node::swimAddRumor(nodekey key, int state, long incarnation) {
+    swim_rumor rumor;
+
+    rumor.node = key;
+    rumor.state = state;
+    rumor.incarnation = incarnation;
+    rumor.sent = 0;
+    for (unsigned int i = 0; i < rumors.size(); i++) {
+        if (rumors[i].node == key) {
+            rumors[i] = rumor;
+            return;
+        }
+    }
+    rumors.push_back(rumor);
+}
+
+/**
+ * FUNCTION NAME: swimRounds
+ *
+ * DESCRIPTION: SWIM_LAMBDA * log2 of the group size, rounded up. An update
+ * 				reaches the whole group with high probability in that many rounds.
+ */
+int MP1Node::swimRounds() {
+    int rounds = SWIM_LAMBDA;
+    for (unsigned int n = memberNode->memberList.size() + 1; n > 1; n >>= 1) {
+        rounds += SWIM_LAMBDA;
+    }
+    return rounds;
+}
+
+/**
+ * FUNCTION NAME: swimPiggyback
+ *
+ * DESCRIPTION: Pick up to max updates for a message to node to. An update about
+ * 				the receiver goes first so a suspect hears of it, then the least sent
+ * 				ones. An update is dropped once it went out swimRounds() times.
+ *
+ * RETURNS:
+ * number of updates written to out
+ */
+int MP1Node::swimPiggyback(nodekey to, SwimUpdate *out, int max) {
+    int count = 0;
+    int limit = swimRounds();
+
+    while (count < max) {
+        int best = -1;
+        for (int i = 0; i < (int)rumors.size(); i++) {
+            if (rumors[i].sent < 0) {
+                continue;
+            }
+            if (rumors[i].node == to) {
+                best = i;
+                break;
+            }
+            if (best < 0 || rumors[i].sent < rumors[best].sent) {
+                best = i;
+            }
+        }
+        if (best < 0) {
+            break;
+        }
+        SwimUpdate update;
+        int id = keyId(rumors[best].node);
+        short port = keyPort(rumors[best].node);
+        memset(&update, 0, sizeof(SwimUpdate));
+        memcpy(&update.addr[0], &id, sizeof(int));
+        memcpy(&update.addr[4], &port, sizeof(short));
+        update.state = rumors[best].state;
+        update.incarnation = rumors[best].incarnation;
+        memcpy(&out[count++], &update, sizeof(SwimUpdate));
+        // Marked as taken for this message, counted below
+        rumors[best].sent = -rumors[best].sent - 1;
+    }
+
+    for (unsigned int i = 0; i < rumors.size(); i++) {
+        if (rumors[i].sent < 0) {
+            rumors[i].sent = -rumors[i].sent;
+            if (rumors[i].sent >= limit) {
+                rumors[i] = rumors.back();
+                rumors.pop_back();
+                i--;
+            }
+        }
+    }
+    return count;
+}
+
+/**
+ * FUNCTION NAME: selfKey
+ *
+ * DESCRIPTION: Packed key of this node's own address
+ */
+nodekey MP1Node::selfKey() {
+    int id;
+    short port;
+    memcpy(&id, &memberNode->addr.addr[0], sizeof(int));
+    memcpy(&port, &memberNode->addr.addr[4], sizeof(short));
+    return packKey(id, port);
+}
+/**
+ * FUNCTION NAME: isNullAddress
+ *
+ * DESCRIPTION: Function checks if the address is NULL
+ */
+int MP1Node::isNullAddress(Address *addr) {
+	return (memcmp(addr->addr, NULLADDR, 6) == 0 ? 1 : 0);
+}
+
+/**
+ * FUNCTION NAME: getJoinAddress
+ *
+ * DESCRIPTION: Returns the Address of the seed to join through, this node's own
+ * 				address if it boots the group
+ */
+Address MP1Node::getJoinAddress() {
+    int self = keyId(selfKey());
+    vector<int> &seeds = par->INTRODUCERS;
+
+    // The first seed boots the group
+    if (self == seeds[0]) {
+        return memberNode->addr;
+    }
+    // Anyone else spreads over the seeds by a hash of its id, skipping itself
+    joinSeed = (unsigned int)(((unsigned long long)self * 0x9E3779B97F4A7C15ULL) >> 32) % seeds.size();
+    if (seeds[joinSeed] == self) {
+        joinSeed = (joinSeed + 1) % seeds.size();
+    }
+    return seedAddress(joinSeed);
+}
+
+/**
+ * FUNCTION NAME: seedAddress
+ *
+ * DESCRIPTION: Address of the seed-th introducer
+ */
+Address MP1Node::seedAddress(unsigned int seed) {
+    Address joinaddr;
+
+    memset(&joinaddr, 0, sizeof(Address));
+    *(int *)(&joinaddr.addr) = par->INTRODUCERS[seed];
+    *(short *)(&joinaddr.addr[4]) = 0;
+
+    return joinaddr;
+}
+
+/**
+ * FUNCTION NAME: initMemberListTable
+ *
+ * DESCRIPTION: Initialize the membership list
+ */
+void MP1Node::initMemberListTable(Member *memberNode) {
+	memberNode->memberList.clear();
+}
+
+/**
+ * FUNCTION NAME: printAddress
+ *
+ * DESCRIPTION: Print the Address
+ */
+void MP1Node::printAddress(Address *addr)
+{
+    printf("%d.%d.%d.%d:%d \n",  addr->addr[0],addr->addr[1],addr->addr[2],
+                                                       addr->addr[3], *(short*)&addr->addr[4]) ;    
+}
@@ -1,90 +1,341 @@
-/**********************************
- * FILE NAME: MP1Node.cpp
- *
- * DESCRIPTION: Membership protocol run by this Node.
- * 				Header file of MP1Node class.
- **********************************/
-
-#ifndef _MP1NODE_H_
-#define _MP1NODE_H_
-
-#include "stdincludes.h"
-#include "Log.h"
-#include "Params.h"
-#include "Member.h"
-#include "EmulNet.h"
-#include "Queue.h"
-#include <unordered_map>
-#include <cassert>
-
-/**
- * Macros
- */
-#define TREMOVE 20
-#define TFAIL 5
-
-/*
- * Note: You can change/add any functions in MP1Node.{h,cpp}
- */
-
-/**
- * Message Types
- */
-enum MsgTypes{
-    JOINREQ,
-    JOINREP,
-    HEARTBEAT,
-};
-
-/**
- * STRUCT NAME: MessageHdr
- *
- * DESCRIPTION: Header and content of a message
- */
-typedef struct MessageHdr {
-	enum MsgTypes msgType;
-}MessageHdr;
-
-/**
- * CLASS NAME: MP1Node
- *
- * DESCRIPTION: Class implementing Membership protocol functionalities for failure detection
- */
-class MP1Node {
-private:
-	EmulNet *emulNet;
-	Log *log;
-	Params *par;
-	Member *memberNode;
-	char NULLADDR[6];
-	 
-
-public:
-	MP1Node(Member *, Params *, EmulNet *, Log *, Address *);
-	Member * getMemberNode() {
-		return memberNode;
-	}
-	unordered_map<string, int> nodetable;
-	int recvLoop();
-	static int enqueueWrapper(void *env, char *buff, int size);
-	void nodeStart(char *servaddrstr, short serverport);
-	int initThisNode(Address *joinaddr);
-	int introduceSelfToGroup(Address *joinAddress);
-	int finishUpThisNode();
-	void nodeLoop();
-	void checkMessages();
-	void recvCallBack(void *env, char *data, int size);
-	void nodeLoopOps();
-	int isNullAddress(Address *addr);
-	Address getJoinAddress();
-	void initMemberListTable(Member *memberNode);
-	void printAddress(Address *addr);
-	virtual ~MP1Node();
-	int gettime();
-	void joinreq(char* data);
-	void updatetables(char* data, int size);
-	void sendML(Address *addr);
-	Address createaddress(int id, short port);
-};
-
-#endif /* _MP1NODE_H_ */
+/**********************************
+ * FILE NAME: MP1Node.cpp
+ *
+ * DESCRIPTION: Membership protocol run by this Node.
+ * 				Header file of MP1Node class.
+ **********************************/
+
+#ifndef _MP1NODE_H_
+#define _MP1NODE_H_
+
+#include "stdincludes.h"
+#include "Log.h"
+#include "Params.h"
+#include "Member.h"
+#include "EmulNet.h"
+#include "Queue.h"
+#include "NodeIndex.h"
+#include <cassert>
+
+/**
+ * Macros
+ */
+#define TREMOVE 20
+#define TFAIL 5
+// SWIM updates are piggybacked SWIM_LAMBDA * log2(group size) times, suspects get as many periods to refute
+#define SWIM_LAMBDA 3
+// Version byte of the heartbeat encoding, and the most bytes one entry takes in it
+#define HB_VERSION 1
+#define HB_MAX_ENTRY 18
+// Phi detector: inter-arrival times kept per member, samples needed before phi is
+// trusted over TREMOVE, and the smallest standard deviation assumed, in ticks
+#define PHI_WINDOW 32
+#define PHI_MIN_SAMPLES 4
+#define PHI_MIN_STDDEV 2.0
+// Doublings of the wait for a join reply, 2^5 JOIN_TIMEOUTs at most
+#define JOIN_BACKOFF_MAX 5
+// Transport channels with piggybacking on: membership messages, KV store messages, and
+// KV store messages behind a membership delta
+#define CH_MEMBERSHIP 0
+#define CH_KV 1
+#define CH_KV_DELTA 2
+
+/*
+ * Note: You can change/add any functions in MP1Node.{h,cpp}
+ */
+
+/**
+ * Message Types
+ */
+enum MsgTypes{
+    JOINREQ,
+    JOINREP,
+    HEARTBEAT,
+    PING,
+    PINGREQ,
+    ACK,
+    LEAVE,
+};
+
+/**
+ * States a SWIM member can be reported in
+ */
+enum swimSTATE { SWIM_ALIVE, SWIM_SUSPECT, SWIM_CONFIRM };
+
+/**
+ * STRUCT NAME: MessageHdr
+ *
+ * DESCRIPTION: Header and content of a message
+ */
+typedef struct MessageHdr {
+	enum MsgTypes msgType;
+}MessageHdr;
+
+/**
+ * STRUCT NAME: SwimHdr
+ *
+ * DESCRIPTION: Follows the MessageHdr of PING, PINGREQ, ACK and the SWIM JOINREP.
+ * 				target is the node pinged for a PINGREQ and the node that answered
+ * 				for an ACK. count SwimUpdate records follow.
+ */
+typedef struct SwimHdr {
+	int seq;
+	char from[6];
+	char target[6];
+	long incarnation;
+	int count;
+}SwimHdr;
+
+/**
+ * STRUCT NAME: SwimUpdate
+ *
+ * DESCRIPTION: Membership update piggybacked on a SWIM message
+ */
+typedef struct SwimUpdate {
+	char addr[6];
+	char state;
+	long incarnation;
+}SwimUpdate;
+
+/**
+ * STRUCT NAME: phi_window
+ *
+ * DESCRIPTION: Last PHI_WINDOW heartbeat inter-arrival times of a member, in a
+ * 				ring, with their running sum and sum of squares
+ */
+typedef struct phi_window {
+	int intervals[PHI_WINDOW];
+	int count;
+	int next;
+	long sum;
+	long sumsq;
+}phi_window;
+
+/**
+ * STRUCT NAME: member_expiry
+ *
+ * DESCRIPTION: Tick a member is due to be removed at, unless it was refreshed
+ * 				since the deadline was computed
+ */
+typedef struct member_expiry {
+	int deadline;
+	nodekey node;
+}member_expiry;
+
+/**
+ * STRUCT NAME: laterExpiry
+ *
+ * DESCRIPTION: Heap comparator, true if a is due after b
+ */
+struct laterExpiry {
+	bool operator()(const member_expiry &a, const member_expiry &b) const {
+		return a.deadline > b.deadline;
+	}
+};
+
+/**
+ * STRUCT NAME: gossip_sync
+ *
+ * DESCRIPTION: Lists a node gossips. A list that does not fit in one message goes
+ * 				out over as many gossip rounds, each message starting at the key the
+ * 				previous one stopped at.
+ */
+typedef struct gossip_sync {
+	// Start tick of the last two lists, and of the last full list, sent to the end
+	int sent;
+	int before;
+	int full;
+	// List being sent: start tick, entries refreshed after since or -1 for all,
+	// and the key the next message starts at, NODEKEY_EMPTY once it is sent
+	int start;
+	long since;
+	nodekey cursor;
+}gossip_sync;
+
+/**
+ * STRUCT NAME: swim_rumor
+ *
+ * DESCRIPTION: Update waiting in the dissemination buffer, with the number of
+ * 				messages it went out on so far
+ */
+typedef struct swim_rumor {
+	nodekey node;
+	int state;
+	long incarnation;
+	int sent;
+}swim_rumor;
+
+/**
+ * STRUCT NAME: leave_rumor
+ *
+ * DESCRIPTION: Node heard leaving, with the gossip rounds it was forwarded in so far
+ */
+typedef struct leave_rumor {
+	nodekey node;
+	int sent;
+}leave_rumor;
+
+/**
+ * STRUCT NAME: swim_relay
+ *
+ * DESCRIPTION: PINGREQ this node is serving, the ACK for seq goes back to
+ * 				requester as an ACK for reqSeq
+ */
+typedef struct swim_relay {
+	int seq;
+	nodekey target;
+	nodekey requester;
+	int reqSeq;
+	int expires;
+}swim_relay;
+
+/**
+ * CLASS NAME: MP1Node
+ *
+ * DESCRIPTION: Class implementing Membership protocol functionalities for failure detection
+ */
+class MP1Node {
+private:
+	EmulNet *emulNet;
+	Log *log;
+	Params *par;
+	Member *memberNode;
+	char NULLADDR[6];
+	// Gossip traffic of this node, full lists and deltas
+	long fullMsgs, fullBytes;
+	long deltaMsgs, deltaBytes;
+	// List gossiped, and entries the last message of a chunked list held
+	gossip_sync gossipSync;
+	int gossipChunkRoom;
+	// Gossip message of the tick hbCacheTime
+	vector<char> hbCache;
+	int hbCacheTime;
+	// KV store messages carry membership deltas, quiet ticks after one, see setPiggyback
+	bool piggyback;
+	int piggybackQuiet;
+	// Tick of the last KV message that carried every recent change to each peer
+	NodeIndex lastPiggyback;
+	long piggyMsgs, piggyBytes, gossipSkipped;
+	// Scratch of encodeML, by membership list slot
+	vector<char> fresh;
+	// Ticks between gossip rounds, last and next round, last change to the list
+	int gossipInterval;
+	int lastGossip;
+	int nextGossip;
+	int lastChange;
+	// Tick this node first knew every other node of the run, -1 until then
+	int completeAt;
+	// Tick of the last nodeLoop, the heartbeat counts the ticks since nodeStart
+	int loopedAt;
+	// Seed this node last asked to join through, and when to ask the next one
+	unsigned int joinSeed;
+	int joinRetryAt;
+	// Joiners to answer once this tick's messages are handled, tick each was last answered
+	vector<nodekey> joinQueue;
+	NodeIndex joinAnswered;
+	long joinsAnswered, joinRetries;
+	// SWIM: own incarnation, the running probe and its place in the probe order
+	long incarnation;
+	int nextSeq;
+	int probeSeq;
+	int probeStart;
+	bool probeAcked;
+	bool probeIndirect;
+	nodekey probeTarget;
+	vector<nodekey> probeOrder;
+	unsigned int probeNext;
+	// SWIM: tick each suspect was suspected at, incarnation each dead node was confirmed at
+	NodeIndex suspectAt;
+	NodeIndex confirmed;
+	vector<swim_rumor> rumors;
+	vector<swim_relay> relays;
+	long swimMsgs, swimBytes;
+	long suspicions, refutations;
+	// Tick this node announced its leave at, -1 while it has not
+	int leaveAt;
+	// Leaves to forward with the next gossip rounds
+	vector<leave_rumor> leaves;
+	long leaveMsgs, leaveBytes;
+	// Heartbeat inter-arrival times, by membership list slot, with the phi detector only
+	vector<phi_window> arrivals;
+	// Tick each removed node was removed at, while a later heartbeat would be a false positive
+	NodeIndex removedAt;
+	long removals, falsePositives;
+	long latencySum, latencyMax;
+	// Removal deadlines of the gossip detector, earliest first, and the deadline of
+	// the one live entry of each member; any other entry of the member is stale
+	priority_queue<member_expiry, vector<member_expiry>, laterExpiry> expiries;
+	NodeIndex expiryAt;
+	 
+
+public:
+	MP1Node(Member *, Params *, EmulNet *, Log *, Address *);
+	Member * getMemberNode() {
+		return memberNode;
+	}
+	// Slot in memberList of every known node, by packed id:port key
+	NodeIndex nodetable;
+	// Keys of the membership list in ascending order
+	vector<nodekey> sortedKeys;
+	int recvLoop();
+	static int enqueueWrapper(void *env, char *buff, int size);
+	void nodeStart(char *servaddrstr, short serverport);
+	int initThisNode(Address *joinaddr);
+	int introduceSelfToGroup(Address *joinAddress);
+	int finishUpThisNode();
+	void logStats();
+	void nodeLoop();
+	void checkMessages();
+	void recvCallBack(void *env, char *data, int size);
+	void nodeLoopOps();
+	int isNullAddress(Address *addr);
+	Address getJoinAddress();
+	void initMemberListTable(Member *memberNode);
+	void printAddress(Address *addr);
+	virtual ~MP1Node();
+	int gettime();
+	void joinreq(char* data);
+	void queueJoin(nodekey key);
+	void answerJoins();
+	void retryJoin();
+	Address seedAddress(unsigned int seed);
+	void updatetables(char* data, int size);
+	void mergeEntry(int id, short port, long heartbeat);
+	nodekey encodeML(long since, nodekey from, vector<char> &msg, int reserve);
+	void sendML(Address *addr);
+	void encodeGossip();
+	void setPiggyback(int quiet);
+	void sendKV(Address *addr, string kv);
+	void recvKV(char *data, int size);
+	static char *kvPayload(char *data, int &size);
+	void sendLeave(nodekey to, vector<nodekey> &nodes);
+	void recvLeave(char *data, int size);
+	void forwardLeaves(vector<nodekey> &peers);
+	Address createaddress(int id, short port);
+	nodekey selfKey();
+	int gossipChunks();
+	int gossipStretch();
+	long getGossipBytes();
+	int getLastChange();
+	int getCompleteAt();
+	int nextWake();
+	int addMember(int id, short port, long heartbeat);
+	void removeMember(int slot);
+	void publishEvent(int type, int id, short port);
+	void swimLoopOps();
+	void swimRecv(MsgTypes msgtype, char *data, int size);
+	void swimApply(nodekey key, int state, long incarnation);
+	void swimJoinreq(char *data);
+	void swimSend(MsgTypes msgtype, int seq, nodekey to, nodekey target);
+	void swimSendJoinList(nodekey to);
+	void swimAddRumor(nodekey key, int state, long incarnation);
+	int swimPiggyback(nodekey to, SwimUpdate *out, int max);
+	int swimRounds();
+	void phiRecord(int slot, int interval);
+	double phi(int slot, long silent);
+	int expireAt(int slot);
+	nodekey swimNextTarget();
+	void swimPingReq();
+};
+
+#endif /* _MP1NODE_H_ */
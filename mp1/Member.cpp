@@ -38,35 +38,30 @@ bool Address::operator ==(const Address& anotherAddress) {
 }
 
 /**
- * Constructor
- */
-MemberListEntry::MemberListEntry(int id, short port, long heartbeat, long timestamp): id(id), port(port), heartbeat(heartbeat), timestamp(timestamp) {}
-
-/**
- * Constuctor
+ * FUNCTION NAME: size
+ *
+ * DESCRIPTION: Number of members in the table
  */
-MemberListEntry::MemberListEntry(int id, short port): id(id), port(port) {}
+int MemberTable::size() {
+	return keys.size();
+}
 
 /**
- * Copy constructor
+ * FUNCTION NAME: empty
+ *
+ * DESCRIPTION: True if the table holds no member
  */
-MemberListEntry::MemberListEntry(const MemberListEntry &anotherMLE) {
-	this->heartbeat = anotherMLE.heartbeat;
-	this->id = anotherMLE.id;
-	this->port = anotherMLE.port;
-	this->timestamp = anotherMLE.timestamp;
+bool MemberTable::empty() {
+	return keys.empty();
 }
 
 /**
- * Assignment operator overloading
+ * FUNCTION NAME: getkey
+ *
+ * DESCRIPTION: getter, packed id:port key of the member in slot
  */
-MemberListEntry& MemberListEntry::operator =(const MemberListEntry &anotherMLE) {
-	MemberListEntry temp(anotherMLE);
-	swap(heartbeat, temp.heartbeat);
-	swap(id, temp.id);
-	swap(port, temp.port);
-	swap(timestamp, temp.timestamp);
-	return *this;
+nodekey MemberTable::getkey(int slot) {
+	return keys[slot];
 }
 
 /**
@@ -74,8 +69,8 @@ MemberListEntry& MemberListEntry::operator =(const MemberListEntry &anotherMLE)
  *
  * DESCRIPTION: getter
  */
-int MemberListEntry::getid() {
-	return id;
+int MemberTable::getid(int slot) {
+	return keyId(keys[slot]);
 }
 
 /**
@@ -83,8 +78,8 @@ int MemberListEntry::getid() {
  *
  * DESCRIPTION: getter
  */
-short MemberListEntry::getport() {
-	return port;
+short MemberTable::getport(int slot) {
+	return keyPort(keys[slot]);
 }
 
 /**
@@ -92,8 +87,8 @@ short MemberListEntry::getport() {
  *
  * DESCRIPTION: getter
  */
-long MemberListEntry::getheartbeat() {
-	return heartbeat;
+long MemberTable::getheartbeat(int slot) {
+	return heartbeats[slot];
 }
 
 /**
@@ -101,44 +96,81 @@ long MemberListEntry::getheartbeat() {
  *
  * DESCRIPTION: getter
  */
-long MemberListEntry::gettimestamp() {
-	return timestamp;
+long MemberTable::gettimestamp(int slot) {
+	return timestamps[slot];
 }
 
 /**
- * FUNCTION NAME: setid
+ * FUNCTION NAME: setheartbeat
  *
  * DESCRIPTION: setter
  */
-void MemberListEntry::setid(int id) {
-	this->id = id;
+void MemberTable::setheartbeat(int slot, long heartbeat) {
+	heartbeats[slot] = (int)heartbeat;
 }
 
 /**
- * FUNCTION NAME: setport
+ * FUNCTION NAME: settimestamp
  *
  * DESCRIPTION: setter
  */
-void MemberListEntry::setport(short port) {
-	this->port = port;
+void MemberTable::settimestamp(int slot, long timestamp) {
+	timestamps[slot] = (int)timestamp;
 }
 
 /**
- * FUNCTION NAME: setheartbeat
+ * FUNCTION NAME: add
  *
- * DESCRIPTION: setter
+ * DESCRIPTION: Append a member, its slot is the old size of the table
  */
-void MemberListEntry::setheartbeat(long hearbeat) {
-	this->heartbeat = hearbeat;
+void MemberTable::add(int id, short port, long heartbeat, long timestamp) {
+	keys.push_back(packKey(id, port));
+	heartbeats.push_back((int)heartbeat);
+	timestamps.push_back((int)timestamp);
 }
 
 /**
- * FUNCTION NAME: settimestamp
+ * FUNCTION NAME: remove
  *
- * DESCRIPTION: setter
+ * DESCRIPTION: Drop the member in slot, the last member moves into slot
+ */
+void MemberTable::remove(int slot) {
+	keys[slot] = keys.back();
+	heartbeats[slot] = heartbeats.back();
+	timestamps[slot] = timestamps.back();
+	keys.pop_back();
+	heartbeats.pop_back();
+	timestamps.pop_back();
+}
+
+/**
+ * FUNCTION NAME: clear
+ *
+ * DESCRIPTION: Drop every member
  */
-void MemberListEntry::settimestamp(long timestamp) {
-	this->timestamp = timestamp;
+void MemberTable::clear() {
+	keys.clear();
+	heartbeats.clear();
+	timestamps.clear();
+}
+
+/**
+ * FUNCTION NAME: markFresh
+ *
+ * DESCRIPTION: Set fresh[slot] to 1 for every member refreshed at oldest or later and
+ * 				after since, to 0 for the others. One pass over the timestamp array
+ * 				without branches, which the compiler can vectorize.
+ */
+void MemberTable::markFresh(long oldest, long since, vector<char> &fresh) {
+	int n = timestamps.size();
+	const int *ts = timestamps.data();
+	int low = (int)max(oldest, since + 1);
+
+	fresh.resize(n);
+	char *out = fresh.data();
+	for ( int i = 0; i < n; i++ ) {
+		out[i] = ts[i] >= low;
+	}
 }
 
 /**
@@ -149,13 +181,17 @@ Member::Member(const Member &anotherMember) {
 	this->inited = anotherMember.inited;
 	this->inGroup = anotherMember.inGroup;
 	this->bFailed = anotherMember.bFailed;
+	this->bLeaving = anotherMember.bLeaving;
 	this->nnb = anotherMember.nnb;
 	this->heartbeat = anotherMember.heartbeat;
 	this->pingCounter = anotherMember.pingCounter;
 	this->timeOutCounter = anotherMember.timeOutCounter;
 	this->memberList = anotherMember.memberList;
-	this->myPos = anotherMember.myPos;
+	this->epoch = anotherMember.epoch;
+	this->watchEvents = anotherMember.watchEvents;
+	this->events = anotherMember.events;
 	this->mp1q = anotherMember.mp1q;
+	this->mp2q = anotherMember.mp2q;
 }
 
 /**
@@ -166,12 +202,16 @@ Member& Member::operator =(const Member& anotherMember) {
 	this->inited = anotherMember.inited;
 	this->inGroup = anotherMember.inGroup;
 	this->bFailed = anotherMember.bFailed;
+	this->bLeaving = anotherMember.bLeaving;
 	this->nnb = anotherMember.nnb;
 	this->heartbeat = anotherMember.heartbeat;
 	this->pingCounter = anotherMember.pingCounter;
 	this->timeOutCounter = anotherMember.timeOutCounter;
 	this->memberList = anotherMember.memberList;
-	this->myPos = anotherMember.myPos;
+	this->epoch = anotherMember.epoch;
+	this->watchEvents = anotherMember.watchEvents;
+	this->events = anotherMember.events;
 	this->mp1q = anotherMember.mp1q;
+	this->mp2q = anotherMember.mp2q;
 	return *this;
 }
@@ -0,0 +1,155 @@
+/**********************************
+ * FILE NAME: MsgPool.cpp
+ *
+ * DESCRIPTION: Definition of the size-class message pool
+ **********************************/
+
+#include "MsgPool.h"
+
+/**
+ * Constructor
+ */
+MsgPool::MsgPool(): oversize(0), shared(false) {
+	init(0);
+}
+
+/**
+ * Destructor
+ */
+MsgPool::~MsgPool() {
+	for ( unsigned int i = 0; i < slabs.size(); i++ ) {
+		free(slabs[i]);
+	}
+}
+
+/**
+ * FUNCTION NAME: init
+ *
+ * DESCRIPTION: Set up the size classes. The last class holds maxSize bytes.
+ */
+void MsgPool::init(int maxSize) {
+	int i;
+	classSize[0] = 64;
+	classSize[1] = 256;
+	classSize[2] = 1024;
+	classSize[3] = maxSize > 1024 ? maxSize : 1024;
+	for ( i = 0; i < POOL_CLASSES; i++ ) {
+		hits[i] = 0;
+		misses[i] = 0;
+		inUse[i] = 0;
+		highWater[i] = 0;
+	}
+}
+
+/**
+ * FUNCTION NAME: classOf
+ *
+ * DESCRIPTION: Smallest size class that fits size bytes
+ *
+ * RETURNS:
+ * index of the class, -1 if the block is bigger than the largest class
+ */
+int MsgPool::classOf(int size) {
+	for ( int i = 0; i < POOL_CLASSES; i++ ) {
+		if ( size <= classSize[i] ) {
+			return i;
+		}
+	}
+	return -1;
+}
+
+/**
+ * FUNCTION NAME: refill
+ *
+ * DESCRIPTION: Carve a new slab into blocks and put them on the free list
+ */
+void MsgPool::refill(int sizeClass) {
+	size_t blockSize = sizeof(pool_hdr) + classSize[sizeClass];
+	char *slab = (char *) malloc(blockSize * POOL_SLAB_BLOCKS);
+
+	slabs.push_back(slab);
+	for ( int i = POOL_SLAB_BLOCKS - 1; i >= 0; i-- ) {
+		pool_hdr *hdr = (pool_hdr *)(slab + i * blockSize);
+		hdr->sizeClass = sizeClass;
+		freeList[sizeClass].push_back(hdr + 1);
+	}
+}
+
+/**
+ * FUNCTION NAME: alloc
+ *
+ * DESCRIPTION: Get a block of at least size bytes
+ */
+void *MsgPool::alloc(int size) {
+	int sizeClass = classOf(size);
+	pool_hdr *hdr;
+	std::unique_lock<std::mutex> guard(lock, std::defer_lock);
+
+	if ( shared ) {
+		guard.lock();
+	}
+
+	if ( sizeClass < 0 ) {
+		// Too big for any class, fall back to malloc
+		oversize++;
+		hdr = (pool_hdr *) malloc(sizeof(pool_hdr) + size);
+		hdr->sizeClass = -1;
+		return hdr + 1;
+	}
+
+	if ( freeList[sizeClass].empty() ) {
+		misses[sizeClass]++;
+		refill(sizeClass);
+	}
+	else {
+		hits[sizeClass]++;
+	}
+
+	void *ptr = freeList[sizeClass].back();
+	freeList[sizeClass].pop_back();
+	if ( ++inUse[sizeClass] > highWater[sizeClass] ) {
+		highWater[sizeClass] = inUse[sizeClass];
+	}
+	return ptr;
+}
+
+/**
+ * FUNCTION NAME: release
+ *
+ * DESCRIPTION: Return a block obtained from alloc to its free list
+ */
+void MsgPool::release(void *ptr) {
+	pool_hdr *hdr = (pool_hdr *)ptr - 1;
+	std::unique_lock<std::mutex> guard(lock, std::defer_lock);
+
+	if ( shared ) {
+		guard.lock();
+	}
+	if ( hdr->sizeClass < 0 ) {
+		free(hdr);
+		return;
+	}
+	inUse[hdr->sizeClass]--;
+	freeList[hdr->sizeClass].push_back(ptr);
+}
+
+/**
+ * FUNCTION NAME: setShared
+ *
+ * DESCRIPTION: Turn locking on while several threads allocate and release
+ */
+void MsgPool::setShared(bool on) {
+	shared = on;
+}
+
+/**
+ * FUNCTION NAME: report
+ *
+ * DESCRIPTION: Print the pool statistics of this run
+ */
+void MsgPool::report(FILE *file) {
+	for ( int i = 0; i < POOL_CLASSES; i++ ) {
+		fprintf(file, "pool class %5d B: hits %8lu misses %6lu highwater %6lu\n", classSize[i], hits[i], misses[i], highWater[i]);
+	}
+	fprintf(file, "pool oversize allocations %lu\n", oversize);
+}
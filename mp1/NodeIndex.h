@@ -0,0 +1,75 @@
+/**********************************
+ * FILE NAME: NodeIndex.h
+ *
+ * DESCRIPTION: Packed node keys and the flat index from key to membership list slot
+ **********************************/
+
+#ifndef _NODEINDEX_H_
+#define _NODEINDEX_H_
+
+#include "stdincludes.h"
+
+/*
+ * Macros
+ */
+#define NODEINDEX_MINCAP 16
+// Never a valid key, id and port of a real node fit in 48 bits
+#define NODEKEY_EMPTY (~0ULL)
+
+typedef unsigned long long nodekey;
+
+/**
+ * FUNCTION NAME: packKey
+ *
+ * DESCRIPTION: Key of the node id:port, id << 16 | port
+ */
+inline nodekey packKey(int id, short port) {
+	return ((nodekey)(unsigned int)id << 16) | (unsigned short)port;
+}
+
+/**
+ * FUNCTION NAME: keyId
+ *
+ * DESCRIPTION: Node id of a packed key
+ */
+inline int keyId(nodekey key) {
+	return (int)(key >> 16);
+}
+
+/**
+ * FUNCTION NAME: keyPort
+ *
+ * DESCRIPTION: Port of a packed key
+ */
+inline short keyPort(nodekey key) {
+	return (short)(key & 0xffff);
+}
+
+/**
+ * CLASS NAME: NodeIndex
+ *
+ * DESCRIPTION: Open addressing hash table from packed node key to an int, the slot
+ * 				of the node in the membership list. Linear probing over a power of two
+ * 				capacity kept at most half full; erase shifts the following entries
+ * 				back so no tombstones are needed.
+ */
+class NodeIndex {
+private:
+	vector<nodekey> keys;
+	vector<int> values;
+	int count;
+	unsigned int mask;
+	unsigned int home(nodekey key);
+	void grow();
+public:
+	NodeIndex();
+	int find(nodekey key);
+	bool contains(nodekey key);
+	void set(nodekey key, int value);
+	void erase(nodekey key);
+	void clear();
+	int size();
+	virtual ~NodeIndex();
+};
+
+#endif /* _NODEINDEX_H_ */
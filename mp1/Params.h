@@ -1,39 +1,81 @@
-/**********************************
- * FILE NAME: Params.h
- *
- * DESCRIPTION: Header file of Parameter class
- **********************************/
-
-#ifndef _PARAMS_H_
-#define _PARAMS_H_
-
-#include "stdincludes.h"
-#include "Params.h"
-#include "Member.h"
-
-enum testTYPE { CREATE_TEST, READ_TEST, UPDATE_TEST, DELETE_TEST };
-
-/**
- * CLASS NAME: Params
- *
- * DESCRIPTION: Params class describing the test cases
- */
-class Params{
-public:
-	int MAX_NNB;                // max number of neighbors
-	int SINGLE_FAILURE;			// single/multi failure
-	double MSG_DROP_PROB;		// message drop probability
-	double STEP_RATE;		    // dictates the rate of insertion
-	int EN_GPSZ;			    // actual number of peers
-	int MAX_MSG_SIZE;
-	int DROP_MSG;
-	int dropmsg;
-	int globaltime;
-	int allNodesJoined;
-	short PORTNUM;
-	Params();
-	void setparams(char *);
-	int getcurrtime();
-};
-
-#endif /* _PARAMS_H_ */
+/**********************************
+ * FILE NAME: Params.h
+ *
+ * DESCRIPTION: Header file of Parameter class
+ **********************************/
+
+#ifndef _PARAMS_H_
+#define _PARAMS_H_
+
+#include "stdincludes.h"
+#include "Params.h"
+#include "Member.h"
+
+/*
+ * Macros
+ */
+// default cap on messages in flight in the EmulNet
+#define ENBUFFSIZE 30000
+
+enum testTYPE { CREATE_TEST, READ_TEST, UPDATE_TEST, DELETE_TEST };
+enum overflowTYPE { DROP_NEWEST, DROP_OLDEST, BACK_PRESSURE };
+enum transportTYPE { EMUL_TRANSPORT, UDP_TRANSPORT };
+enum gossipTYPE { GOSSIP_FULL, GOSSIP_DELTA };
+enum membershipTYPE { MEMBERSHIP_GOSSIP, MEMBERSHIP_SWIM };
+enum detectorTYPE { FIXED_DETECTOR, PHI_DETECTOR };
+enum engineTYPE { TICK_ENGINE, EVENT_ENGINE };
+
+/**
+ * CLASS NAME: Params
+ *
+ * DESCRIPTION: Params class describing the test cases
+ */
+class Params{
+public:
+	int MAX_NNB;                // max number of neighbors
+	int SINGLE_FAILURE;			// single/multi failure
+	double MSG_DROP_PROB;		// message drop probability
+	double STEP_RATE;		    // dictates the rate of insertion
+	int EN_GPSZ;			    // actual number of peers
+	int MAX_MSG_SIZE;
+	int DROP_MSG;
+	int dropmsg;
+	int globaltime;
+	int allNodesJoined;
+	short PORTNUM;
+	int EN_BUFFSIZE;            // max messages in flight in the EmulNet, 0 for no limit
+	int EN_OVERFLOW;            // what the EmulNet does once EN_BUFFSIZE is reached
+	int LATENCY_MIN;            // per-link latency range in ticks, at least 1, the next tick
+	int LATENCY_MAX;
+	int LATENCY_JITTER;         // extra per-message latency, up to this many ticks
+	int EGRESS_BW;              // bytes a node can send per tick, 0 for no limit
+	int TRANSPORT;              // emulated network or loopback UDP, see transportTYPE
+	int UDP_PORT;               // local port of node id 0 with the UDP transport
+	int THREADS;                // threads each tick's nodes are spread over
+	int GOSSIP_MODE;            // whole membership list or changed entries only, see gossipTYPE
+	int FULL_SYNC_PERIOD;       // ticks between full lists in delta mode
+	int GOSSIP_FANOUT;          // peers gossiped to per round
+	int GOSSIP_INTERVAL;        // ticks between gossip rounds, the most the adaptive backoff reaches
+	int GOSSIP_ADAPTIVE;        // 1 for a fanout of ln(group size) and an interval that backs off while stable
+	int MEMBERSHIP;             // heartbeat gossip or SWIM probing, see membershipTYPE
+	int PING_TIMEOUT;           // SWIM: ticks to wait for an ACK, a protocol period is three of them
+	int PINGREQ_K;              // SWIM: members asked to probe a target that missed its ACK
+	int SUSPECT_TIMEOUT;        // SWIM: ticks a suspect has to refute before it is confirmed dead,
+	                            // 0 for SWIM_LAMBDA * log2(group size) protocol periods
+	int PIGGYBACK_MAX;          // SWIM: membership updates carried per message
+	int FAILURE_DETECTOR;       // gossip: remove after TREMOVE ticks or on phi, see detectorTYPE
+	double PHI_THRESHOLD;       // gossip: suspicion level a member is removed at by the phi detector
+	vector<int> INTRODUCERS;    // ids of the seed nodes joins are spread over, the first one boots the group
+	int JOIN_TIMEOUT;           // ticks to wait for a join reply before asking the next seed, 0 for a round trip
+	int LEAVE_TIME;             // tick the LEAVE_COUNT highest-numbered nodes leave the group at
+	int LEAVE_COUNT;            // nodes that leave gracefully at LEAVE_TIME, 0 for none
+	int LEAVE_LINGER;           // ticks a leaving node keeps serving before it stops, 0 for a round trip
+	int ENGINE;                 // visit every node every tick, or only on events, see engineTYPE
+	int WORKERS;                // processes the nodes are spread over, see ShmNet
+	Params();
+	void setparams(char *);
+	void setoption(char *name, char *value);
+	int getcurrtime();
+};
+
+#endif /* _PARAMS_H_ */
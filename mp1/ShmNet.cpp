@@ -0,0 +1,334 @@
+/**********************************
+ * FILE NAME: ShmNet.cpp
+ *
+ * DESCRIPTION: Shared memory multi-process transport, definition file
+ **********************************/
+
+#include "ShmNet.h"
+
+/**
+ * FUNCTION NAME: ringWrite
+ *
+ * DESCRIPTION: Copy len bytes into the ring at byte position pos, wrapping around the end
+ */
+static void ringWrite(shm_ring *ring, unsigned long pos, const void *src, int len) {
+	int off = pos & (SHM_RING_BYTES - 1);
+	int first = min(len, SHM_RING_BYTES - off);
+
+	memcpy(ring->data + off, src, first);
+	memcpy(ring->data, (const char *)src + first, len - first);
+}
+
+/**
+ * FUNCTION NAME: ringRead
+ *
+ * DESCRIPTION: Copy len bytes out of the ring at byte position pos, wrapping around the end
+ */
+static void ringRead(shm_ring *ring, unsigned long pos, void *dst, int len) {
+	int off = pos & (SHM_RING_BYTES - 1);
+	int first = min(len, SHM_RING_BYTES - off);
+
+	memcpy(dst, ring->data + off, first);
+	memcpy((char *)dst + first, ring->data, len - first);
+}
+
+/**
+ * Constructor. Maps the control block, the failed flags and the rings before
+ * any worker is forked so that every process shares them.
+ */
+ShmNet::ShmNet(Params *p, int workers): EmulNet(p), workers(workers), me(0), children(), pumpedAt(-1) {
+	size_t flagBytes = (par->EN_GPSZ + SHM_CACHELINE - 1) / SHM_CACHELINE * SHM_CACHELINE;
+	int i;
+
+	mapSize = SHM_CACHELINE + flagBytes + (size_t)workers * workers * sizeof(shm_ring);
+	region = (char *)mmap(NULL, mapSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+	if ( region == MAP_FAILED ) {
+		perror("mmap");
+		exit(1);
+	}
+
+	ctl = (shm_ctl *)region;
+	new (&ctl->arrived) std::atomic<int>(0);
+	new (&ctl->generation) std::atomic<int>(0);
+	new (&ctl->globaltime) std::atomic<int>(0);
+	failedFlags = region + SHM_CACHELINE;
+	rings = (shm_ring *)(failedFlags + flagBytes);
+	for ( i = 0; i < workers * workers; i++ ) {
+		new (&rings[i].head) std::atomic<unsigned long>(0);
+		new (&rings[i].tail) std::atomic<unsigned long>(0);
+	}
+}
+
+/**
+ * Destructor
+ */
+ShmNet::~ShmNet() {
+	munmap(region, mapSize);
+}
+
+/**
+ * FUNCTION NAME: spawn
+ *
+ * DESCRIPTION: Fork the other workers. The calling process stays worker 0.
+ *
+ * RETURNS:
+ * index of the worker the caller now is
+ */
+int ShmNet::spawn() {
+	pid_t pid;
+	int w;
+
+	for ( w = 1; w < workers; w++ ) {
+		// Nothing buffered before the fork may be written twice
+		fflush(NULL);
+		pid = fork();
+		if ( pid < 0 ) {
+			perror("fork");
+			exit(1);
+		}
+		if ( pid == 0 ) {
+			me = w;
+			children.clear();
+			return me;
+		}
+		children.push_back(pid);
+	}
+	me = 0;
+	return me;
+}
+
+/**
+ * FUNCTION NAME: join
+ *
+ * DESCRIPTION: Wait for the forked workers to exit
+ */
+void ShmNet::join() {
+	for ( unsigned int i = 0; i < children.size(); i++ ) {
+		waitpid(children[i], NULL, 0);
+	}
+	children.clear();
+}
+
+/**
+ * FUNCTION NAME: hosts
+ *
+ * DESCRIPTION: True if the node with this index runs in this worker
+ */
+bool ShmNet::hosts(int index) {
+	return (long)index * workers / par->EN_GPSZ == me;
+}
+
+/**
+ * FUNCTION NAME: ownerOf
+ *
+ * DESCRIPTION: Worker hosting the node with this id. Ids outside the group stay local.
+ */
+int ShmNet::ownerOf(int id) {
+	if ( id < 1 || id > par->EN_GPSZ ) {
+		return me;
+	}
+	return (long)(id - 1) * workers / par->EN_GPSZ;
+}
+
+/**
+ * FUNCTION NAME: ringOf
+ *
+ * DESCRIPTION: Ring carrying the messages of worker from to worker to
+ */
+shm_ring *ShmNet::ringOf(int from, int to) {
+	return &rings[from * workers + to];
+}
+
+/**
+ * FUNCTION NAME: arrive
+ *
+ * DESCRIPTION: Wait until every worker has arrived. The last one to arrive resets
+ * 				the count, advances the shared clock if asked to and releases the others.
+ */
+void ShmNet::arrive(bool advance) {
+	int gen = ctl->generation.load(std::memory_order_acquire);
+
+	if ( ctl->arrived.fetch_add(1, std::memory_order_acq_rel) == workers - 1 ) {
+		ctl->arrived.store(0, std::memory_order_relaxed);
+		if ( advance ) {
+			ctl->globaltime.fetch_add(1, std::memory_order_relaxed);
+		}
+		ctl->generation.fetch_add(1, std::memory_order_release);
+	}
+	else {
+		while ( ctl->generation.load(std::memory_order_acquire) == gen ) {
+			sched_yield();
+		}
+	}
+}
+
+/**
+ * FUNCTION NAME: tick
+ *
+ * DESCRIPTION: End the current tick in this worker
+ *
+ * RETURNS:
+ * the shared time once all workers have ended it
+ */
+int ShmNet::tick() {
+	arrive(true);
+	return ctl->globaltime.load(std::memory_order_acquire);
+}
+
+/**
+ * FUNCTION NAME: barrier
+ *
+ * DESCRIPTION: Wait for all workers without advancing the clock
+ */
+void ShmNet::barrier() {
+	arrive(false);
+}
+
+/**
+ * FUNCTION NAME: markFailed
+ *
+ * DESCRIPTION: Publish the failure of a node to all workers. Visible after the next barrier.
+ */
+void ShmNet::markFailed(int index) {
+	failedFlags[index] = 1;
+}
+
+/**
+ * FUNCTION NAME: isFailed
+ *
+ * DESCRIPTION: True if some worker marked the node with this index as failed
+ */
+bool ShmNet::isFailed(int index) {
+	return failedFlags[index] != 0;
+}
+
+/**
+ * FUNCTION NAME: push
+ *
+ * DESCRIPTION: Append a message to a ring. Only this worker ever writes the ring.
+ *
+ * RETURNS:
+ * false if the ring has no room for it
+ */
+bool ShmNet::push(shm_ring *ring, en_msg *em) {
+	int len = sizeof(en_msg) + em->size;
+	unsigned long tail = ring->tail.load(std::memory_order_relaxed);
+	unsigned long head = ring->head.load(std::memory_order_acquire);
+
+	if ( tail - head + sizeof(int) + len > SHM_RING_BYTES ) {
+		return false;
+	}
+	ringWrite(ring, tail, &len, sizeof(int));
+	ringWrite(ring, tail + sizeof(int), em, len);
+	ring->tail.store(tail + sizeof(int) + len, std::memory_order_release);
+
+	return true;
+}
+
+/**
+ * FUNCTION NAME: pump
+ *
+ * DESCRIPTION: Move everything the other workers sent to this one into the local
+ * 				buffer, keeping the delivery tick stamped by the sender
+ */
+void ShmNet::pump() {
+	shm_ring *ring;
+	unsigned long head, tail;
+	en_msg *em;
+	int len;
+
+	for ( int q = 0; q < workers; q++ ) {
+		if ( q == me ) {
+			continue;
+		}
+		ring = ringOf(q, me);
+		head = ring->head.load(std::memory_order_relaxed);
+		tail = ring->tail.load(std::memory_order_acquire);
+		while ( head != tail ) {
+			ringRead(ring, head, &len, sizeof(int));
+			em = (en_msg *)pool.alloc(len);
+			ringRead(ring, head + sizeof(int), em, len);
+			head += sizeof(int) + len;
+			em->evicted = false;
+			ENtransit(em);
+		}
+		ring->head.store(head, std::memory_order_release);
+	}
+}
+
+/**
+ * FUNCTION NAME: ENpost
+ *
+ * DESCRIPTION: Messages to a node of this worker take the EmulNet path. Messages
+ * 				to another worker are copied into that pair's ring; a full ring
+ * 				counts as an overflow drop.
+ *
+ * RETURNS:
+ * size, 0 if the ring was full
+ */
+int ShmNet::ENpost(en_msg *em) {
+	int src = *(int *)(em->from.addr);
+	int dst = *(int *)(em->to.addr);
+	int now = par->getcurrtime();
+	int size = em->size;
+	int owner = ownerOf(dst);
+
+	if ( owner == me ) {
+		return EmulNet::ENpost(em);
+	}
+
+	em->deliverAt = now + ENdelay(src, dst, size);
+	if ( !push(ringOf(me, owner), em) ) {
+		overflowDrops++;
+		pool.release(em);
+		return 0;
+	}
+	pool.release(em);
+
+	countMsg(sent_msgs, src, now);
+
+	return size;
+}
+
+/**
+ * FUNCTION NAME: ENrecv
+ *
+ * DESCRIPTION: Pump the incoming rings once per tick, then receive as EmulNet does
+ */
+int ShmNet::ENrecv(Address *myaddr, int (* enq)(void *, char *, int), struct timeval *t, int times, void *queue) {
+	if ( pumpedAt != par->getcurrtime() ) {
+		pumpedAt = par->getcurrtime();
+		pump();
+	}
+	return EmulNet::ENrecv(myaddr, enq, t, times, queue);
+}
+
+/**
+ * FUNCTION NAME: ENcleanup
+ *
+ * DESCRIPTION: Workers take turns appending the counts of their own nodes to msgcount.log
+ */
+int ShmNet::ENcleanup() {
+	FILE *file;
+	int i, w;
+
+	emulnet.nextid = 0;
+	ENdrain();
+
+	for ( w = 0; w < workers; w++ ) {
+		if ( w == me ) {
+			file = fopen("msgcount.log", me == 0 ? "w+" : "a");
+			for ( i = 1; i <= par->EN_GPSZ; i++ ) {
+				if ( hosts(i - 1) ) {
+					ENreport(file, i, i);
+				}
+			}
+			fprintf(file, "worker %d ", me);
+			ENreportDrops(file);
+			fclose(file);
+		}
+		barrier();
+	}
+
+	return 0;
+}
@@ -0,0 +1,100 @@
+/**********************************
+ * FILE NAME: ShmNet.h
+ *
+ * DESCRIPTION: Shared memory multi-process transport, header file
+ **********************************/
+
+#ifndef _SHMNET_H_
+#define _SHMNET_H_
+
+#include "stdincludes.h"
+#include "EmulNet.h"
+#include <atomic>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+
+/*
+ * Macros
+ */
+// bytes of each ring, must be a power of two
+#define SHM_RING_BYTES (1 << 20)
+#define SHM_CACHELINE 64
+
+/**
+ * STRUCT NAME: shm_ring
+ *
+ * DESCRIPTION: Single producer / single consumer byte ring carrying the messages
+ * 				of one worker to another. Each record is an int length followed by
+ * 				the en_msg and its payload. head and tail only ever grow and live on
+ * 				their own cache lines.
+ */
+typedef struct shm_ring {
+	// next byte the consumer reads
+	std::atomic<unsigned long> head;
+	char headpad[SHM_CACHELINE - sizeof(std::atomic<unsigned long>)];
+	// next byte the producer writes
+	std::atomic<unsigned long> tail;
+	char tailpad[SHM_CACHELINE - sizeof(std::atomic<unsigned long>)];
+	char data[SHM_RING_BYTES];
+}shm_ring;
+
+/**
+ * STRUCT NAME: shm_ctl
+ *
+ * DESCRIPTION: Tick barrier and clock shared by all workers
+ */
+typedef struct shm_ctl {
+	std::atomic<int> arrived;
+	std::atomic<int> generation;
+	std::atomic<int> globaltime;
+}shm_ctl;
+
+/**
+ * CLASS NAME: ShmNet
+ *
+ * DESCRIPTION: Runs the nodes of one test case in several forked worker processes.
+ * 				Worker w hosts the nodes whose index i has i * workers / EN_GPSZ == w.
+ * 				Traffic between nodes of the same worker stays in the EmulNet buffer,
+ * 				traffic to another worker goes through the ring of that process pair
+ * 				and is moved to the local mailboxes on the first receive of the next
+ * 				tick. A barrier in the shared control block ends every tick and
+ * 				advances the shared clock. Node failures decided by one worker are
+ * 				published through shared flags.
+ */
+class ShmNet : public EmulNet
+{
+private:
+	int workers;
+	int me;
+	size_t mapSize;
+	char *region;
+	shm_ctl *ctl;
+	// failed flag of every node index
+	char *failedFlags;
+	// workers * workers rings, ring from p to q at p * workers + q
+	shm_ring *rings;
+	vector<pid_t> children;
+	// Tick of the last pump of the incoming rings
+	int pumpedAt;
+	shm_ring *ringOf(int from, int to);
+	int ownerOf(int id);
+	bool push(shm_ring *ring, en_msg *em);
+	void pump();
+	void arrive(bool advance);
+	int ENpost(en_msg *em);
+public:
+	ShmNet(Params *p, int workers);
+	virtual ~ShmNet();
+	int spawn();
+	void join();
+	bool hosts(int index);
+	int tick();
+	void barrier();
+	void markFailed(int index);
+	bool isFailed(int index);
+	int ENrecv(Address *myaddr, int (* enq)(void *, char *, int), struct timeval *t, int times, void *queue);
+	int ENcleanup();
+};
+
+#endif /* _SHMNET_H_ */
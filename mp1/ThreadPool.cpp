@@ -0,0 +1,89 @@
+/**********************************
+ * FILE NAME: ThreadPool.cpp
+ *
+ * DESCRIPTION: Definition of the per-tick thread pool
+ **********************************/
+
+#include "ThreadPool.h"
+
+/**
+ * Constructor. Starts size - 1 threads, the caller of run() is slot 0.
+ */
+ThreadPool::ThreadPool(int size): size(size), generation(0), running(0), stopping(false) {
+	for ( int slot = 1; slot < size; slot++ ) {
+		threads.push_back(std::thread(&ThreadPool::work, this, slot));
+	}
+}
+
+/**
+ * Destructor
+ */
+ThreadPool::~ThreadPool() {
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		stopping = true;
+	}
+	started.notify_all();
+	for ( unsigned int i = 0; i < threads.size(); i++ ) {
+		threads[i].join();
+	}
+}
+
+/**
+ * FUNCTION NAME: getSize
+ *
+ * DESCRIPTION: Number of slots, including the calling thread
+ */
+int ThreadPool::getSize() {
+	return size;
+}
+
+/**
+ * FUNCTION NAME: run
+ *
+ * DESCRIPTION: Run job(slot) for every slot and wait for all of them to finish
+ */
+void ThreadPool::run(std::function<void(int)> job) {
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		this->job = job;
+		running = size - 1;
+		generation++;
+	}
+	started.notify_all();
+
+	job(0);
+
+	std::unique_lock<std::mutex> guard(lock);
+	while ( running > 0 ) {
+		finished.wait(guard);
+	}
+}
+
+/**
+ * FUNCTION NAME: work
+ *
+ * DESCRIPTION: Loop of a pool thread, runs its slot of every job
+ */
+void ThreadPool::work(int slot) {
+	long seen = 0;
+
+	while ( true ) {
+		std::unique_lock<std::mutex> guard(lock);
+		while ( !stopping && generation == seen ) {
+			started.wait(guard);
+		}
+		if ( stopping ) {
+			return;
+		}
+		seen = generation;
+		guard.unlock();
+
+		job(slot);
+
+		guard.lock();
+		if ( --running == 0 ) {
+			finished.notify_one();
+		}
+	}
+}
@@ -0,0 +1,29 @@
+#**********************
+#*
+#* Progam Name: MP1. Membership Protocol.
+#*
+#* Current file: UdpScaleTest.sh
+#* About this file: Runs the single failure scenario with 400 nodes over the UDP
+#* transport, more sockets than one epoll_wait batch used to hold. Every node
+#* must join every other one, the failed node must be removed everywhere, and
+#* the run must finish within the time limit.
+#*
+#***********************
+#!/bin/sh
+
+nodes=400
+make > /dev/null
+timeout 600 ./Application testcases/udpsinglefailure400.conf > /dev/null
+if [ $? -ne 0 ]; then
+	echo "UDP $nodes nodes..............FAILED (did not finish)"
+	exit 1
+fi
+joincount=`grep joined dbg.log | cut -d" " -f2,4-7 | sort -u | wc -l`
+failednode=`grep "Node failed at time" dbg.log | sort -u | awk '{print $1}'`
+failcount=`grep removed dbg.log | sort -u | grep $failednode | wc -l`
+if [ $joincount -eq `expr $nodes \* \( $nodes - 1 \)` ] && [ $failcount -ge `expr $nodes - 1` ]; then
+	echo "UDP $nodes nodes..............OK"
+else
+	echo "UDP $nodes nodes..............FAILED ($joincount joins, $failcount removals)"
+	exit 1
+fi
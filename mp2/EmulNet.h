@@ -1,99 +1,161 @@
-/**********************************
- * FILE NAME: EmulNet.h
- *
- * DESCRIPTION: Emulated Network classes header file
- **********************************/
-
-#ifndef _EMULNET_H_
-#define _EMULNET_H_
-
-#define MAX_NODES 1000
-#define MAX_TIME 3600
-#define ENBUFFSIZE 30000
-
-#include "stdincludes.h"
-#include "Params.h"
-#include "Member.h"
-
-using namespace std;
-
-/**
- * Struct Name: en_msg
- */
-typedef struct en_msg {
-	// Number of bytes after the class
-	int size;
-	// Source node
-	Address from;
-	// Destination node
-	Address to;
-}en_msg;
-
-/**
- * Class Name: EM
- */
-class EM {
-public:
-	int nextid;
-	int currbuffsize;
-	int firsteltindex;
-	en_msg* buff[ENBUFFSIZE];
-	EM() {}
-	EM& operator = (EM &anotherEM) {
-		this->nextid = anotherEM.getNextId();
-		this->currbuffsize = anotherEM.getCurrBuffSize();
-		this->firsteltindex = anotherEM.getFirstEltIndex();
-		int i = this->currbuffsize;
-		while (i > 0) {
-			this->buff[i] = anotherEM.buff[i];
-			i--;
-		}
-		return *this;
-	}
-	int getNextId() {
-		return nextid;
-	}
-	int getCurrBuffSize() {
-		return currbuffsize;
-	}
-	int getFirstEltIndex() {
-		return firsteltindex;
-	}
-	void setNextId(int nextid) {
-		this->nextid = nextid;
-	}
-	void settCurrBuffSize(int currbuffsize) {
-		this->currbuffsize = currbuffsize;
-	}
-	void setFirstEltIndex(int firsteltindex) {
-		this->firsteltindex = firsteltindex;
-	}
-	virtual ~EM() {}
-};
-
-/**
- * CLASS NAME: EmulNet
- *
- * DESCRIPTION: This class defines an emulated network
- */
-class EmulNet
-{ 	
-private:
-	Params* par;
-	int sent_msgs[MAX_NODES + 1][MAX_TIME];
-	int recv_msgs[MAX_NODES + 1][MAX_TIME];
-	int enInited;
-	EM emulnet;
-public:
- 	EmulNet(Params *p);
- 	EmulNet(EmulNet &anotherEmulNet);
- 	EmulNet& operator = (EmulNet &anotherEmulNet);
- 	virtual ~EmulNet();
-	void *ENinit(Address *myaddr, short port);
-	int ENsend(Address *myaddr, Address *toaddr, string data);
-	int ENsend(Address *myaddr, Address *toaddr, char *data, int size);
-	int ENrecv(Address *myaddr, int (* enq)(void *, char *, int), struct timeval *t, int times, void *queue);
-	int ENcleanup();
-};
-
-#endif /* _EMULNET_H_ */
+/**********************************
+ * FILE NAME: EmulNet.h
+ *
+ * DESCRIPTION: Emulated Network classes header file
+ **********************************/
+
+#ifndef _EMULNET_H_
+#define _EMULNET_H_
+
+#define EN_BACKPRESSURE -1
+#define EN_WHEELSLOTS 64
+
+#include "stdincludes.h"
+#include "Params.h"
+#include "Member.h"
+#include "MsgPool.h"
+#include <mutex>
+
+using namespace std;
+
+/**
+ * Struct Name: en_msg
+ */
+typedef struct en_msg {
+	// Number of bytes after the class
+	int size;
+	// Source node
+	Address from;
+	// Destination node
+	Address to;
+	// Position in the send order, used by the DROP_OLDEST policy
+	long seq;
+	// Set when the message was evicted from the buffer and must not be delivered
+	bool evicted;
+	// Protocol the payload is for, when several protocols share the transport
+	char channel;
+	// Tick from which the receiver can see the message
+	int deliverAt;
+}en_msg;
+
+/**
+ * Class Name: EM
+ */
+class EM {
+public:
+	int nextid;
+	int currbuffsize;
+	int firsteltindex;
+	// Per-destination mailboxes, indexed by node id
+	vector< deque<en_msg *> > mailbox;
+	// Messages in flight in send order, NULL once delivered or evicted (DROP_OLDEST only)
+	deque<en_msg *> sendorder;
+	// seq of sendorder.front() and of the next message posted
+	long firstseq;
+	long nextseq;
+	EM(): firstseq(0), nextseq(0) {}
+	EM& operator = (EM &anotherEM) {
+		this->nextid = anotherEM.getNextId();
+		this->currbuffsize = anotherEM.getCurrBuffSize();
+		this->firsteltindex = anotherEM.getFirstEltIndex();
+		this->mailbox = anotherEM.mailbox;
+		this->sendorder = anotherEM.sendorder;
+		this->firstseq = anotherEM.firstseq;
+		this->nextseq = anotherEM.nextseq;
+		return *this;
+	}
+	int getNextId() {
+		return nextid;
+	}
+	int getCurrBuffSize() {
+		return currbuffsize;
+	}
+	int getFirstEltIndex() {
+		return firsteltindex;
+	}
+	void setNextId(int nextid) {
+		this->nextid = nextid;
+	}
+	void settCurrBuffSize(int currbuffsize) {
+		this->currbuffsize = currbuffsize;
+	}
+	void setFirstEltIndex(int firsteltindex) {
+		this->firsteltindex = firsteltindex;
+	}
+	virtual ~EM() {}
+};
+
+/**
+ * CLASS NAME: EmulNet
+ *
+ * DESCRIPTION: This class defines an emulated network
+ * 				Other transports derive from it and override ENinit, ENpost, ENrecv
+ * 				and ENcleanup
+ */
+class EmulNet
+{ 	
+protected:
+	Params* par;
+	// Traffic counters, [node id][time]; both dimensions grow on demand
+	vector< vector<int> > sent_msgs;
+	vector< vector<int> > recv_msgs;
+	int enInited;
+	EM emulnet;
+	MsgPool pool;
+	// Why messages did not make it into the buffer
+	long lossDrops;
+	long sizeDrops;
+	long overflowDrops;
+	long backPressured;
+	// Timing wheel of delayed messages, slot = delivery tick % wheel size
+	vector< vector<en_msg *> > wheel;
+	// Last tick moved out of the wheel, and messages still in it
+	int wheelTime;
+	int wheelCount;
+	// Time at which each node's egress link is free again
+	vector<double> egressFree;
+	// Parallel phase state: sends of each thread slot wait in its outbox until
+	// endParallel, deliveries are counted per slot, admission takes admitLock
+	bool parallel;
+	vector< vector<en_msg *> > outbox;
+	vector<int> slotRecv;
+	int queued;
+	std::mutex admitLock;
+	// Told about every message put in flight, with the tick it can be received
+	void (*deliveryHook)(void *env, int dst, int time);
+	void *hookEnv;
+	int ENadmit(int size);
+	bool ENevictOldest();
+	en_msg *ENprepare(Address *myaddr, Address *toaddr, int size);
+	virtual int ENpost(en_msg *em);
+	void ENtransit(en_msg *em);
+	int ENdelay(int src, int dst, int size);
+	void ENdeliver(en_msg *em);
+	void ENadvance();
+	void initWheel();
+	void ENtrimOrder();
+	void ENdrain();
+	void ENreport(FILE *file, int first, int last);
+	void ENreportDrops(FILE *file);
+	void countMsg(vector< vector<int> > &counts, int node, int time);
+	int getMsgCount(vector< vector<int> > &counts, int node, int time);
+public:
+ 	EmulNet(Params *p);
+ 	EmulNet(EmulNet &anotherEmulNet);
+ 	EmulNet& operator = (EmulNet &anotherEmulNet);
+ 	virtual ~EmulNet();
+	virtual void *ENinit(Address *myaddr, short port);
+	int ENsend(Address *myaddr, Address *toaddr, string data);
+	int ENsend(Address *myaddr, Address *toaddr, char *data, int size);
+	int ENsend(Address *myaddr, Address *toaddr, char *data, int size, int channel);
+	static int ENchannel(void *payload);
+	virtual int ENrecv(Address *myaddr, int (* enq)(void *, char *, int), struct timeval *t, int times, void *queue);
+	void ENrelease(void *payload);
+	void beginParallel(int slots);
+	void endParallel();
+	static void ENbind(int slot);
+	void setDeliveryHook(void (*hook)(void *env, int dst, int time), void *env);
+	virtual int ENcleanup();
+};
+
+#endif /* _EMULNET_H_ */
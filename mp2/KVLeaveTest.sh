@@ -0,0 +1,25 @@
+#!/bin/bash
+
+#################################################
+# FILE NAME: KVLeaveTest.sh
+#
+# DESCRIPTION: Three nodes leave in the tick the test keys are inserted.
+#              Every key must still be held by REPLICAS live nodes once
+#              the leaving nodes stopped, and no request may time out.
+#
+# RUN PROCEDURE:
+# $ chmod +x KVLeaveTest.sh
+# $ ./KVLeaveTest.sh
+#################################################
+
+make > /dev/null 2>&1
+out=`./Application ./testcases/leaveinsert.conf 2> /dev/null`
+copies=`echo "$out" | grep "live copies of"`
+timeouts=`echo "$out" | grep "KV requests timed out"`
+echo "$copies"
+if [ "$copies" == "live copies of 100 test keys: 0 with 0, 0 with 1, 0 with 2, 100 with 3+" ] && [ "$timeouts" == "0 KV requests timed out" ]; then
+	echo "Leave during insert..............OK"
+else
+	echo "Leave during insert..............FAILED ($timeouts)"
+	exit 1
+fi
@@ -14,6 +14,13 @@ MP2Node::MP2Node(Member *memberNode, Params *par, EmulNet * emulNet, Log * log,
 	this->emulNet = emulNet;
 	this->log = log;
 	this->memberNode->addr = *address;
+	this->memberNode->watchEvents = true;
+	this->ringEpoch = this->memberNode->epoch;
+	this->membership = NULL;
+	this->timeouts = 0;
+	this->handedOff = false;
+	ringInsert(this->memberNode->addr);
+	buildReplicaTable();
 }
 
 /**
@@ -27,72 +34,157 @@ MP2Node::~MP2Node() {
  * FUNCTION NAME: updateRing
  *
  * DESCRIPTION: This function does the following:
- * 				1) Gets the current membership list from the Membership Protocol (MP1Node)
- * 				   The membership list is returned as a vector of Nodes. See Node class in Node.h
- * 				2) Constructs the ring based on the membership list
- * 				3) Calls the Stabilization Protocol
+ * 				1) Returns right away if the membership epoch has not moved since the
+ * 				   last call
+ * 				2) Applies the join and removal events published by the Membership
+ * 				   Protocol (MP1Node) to the sorted ring, in one merge, see ringMerge.
+ * 				   The removal of this node means it is leaving, its keys are handed
+ * 				   off instead.
+ * 				3) Calls the Stabilization Protocol, or once this node handed its keys
+ * 				   off, sends them to their replicas in the changed ring: nodes that
+ * 				   left with it can still have been replicas in the handoff
  */
 void MP2Node::updateRing() {
-	/*
-	 * Implement this. Parts of it are already implemented
-	 */
-	vector<Node> curMemList;
-	/*
-	 *  Step 1. Get the current membership list from Membership Protocol / MP1
-	 */
-	curMemList = getMembershipList();
+	bool change = false;
+	bool lingering = handedOff;
+	// Virtual nodes of the nodes that joined, and nodes that left, since the last merge
+	vector<Node> added;
+	vector<Address> removed;
 
-	/*
-	 * Step 2: Construct the ring
-	 */
-	// Sort the list based on the hashCode
-	sort(curMemList.begin(), curMemList.end());
+	if ( memberNode->epoch == ringEpoch ) {
+		return;
+	}
 
+	while ( !memberNode->events.empty() ) {
+		MemberEvent &event = memberNode->events.front();
+		Address address;
+		memcpy(&address.addr[0], &event.id, sizeof(int));
+		memcpy(&address.addr[4], &event.port, sizeof(short));
+		if ( event.type == MEMBER_JOINED ) {
+			for ( int v = 0; v < par->VNODES; v++ ) {
+				added.push_back(Node(address, v));
+			}
+		}
+		else if ( address == memberNode->addr ) {
+			change = ringMerge(added, removed) || change;
+			handoff();
+		}
+		else {
+			// A node that joined since the last merge only has to come out of added
+			size_t joined = added.size();
+			for ( size_t i = 0; i < added.size(); ) {
+				if ( added[i].nodeAddress == address ) {
+					added.erase(added.begin() + i);
+				}
+				else {
+					i++;
+				}
+			}
+			if ( added.size() == joined ) {
+				removed.push_back(address);
+			}
+		}
+		memberNode->events.pop();
+	}
+	ringEpoch = memberNode->epoch;
+	change = ringMerge(added, removed) || change;
 
-	/*
-	 * Step 3: Run the stabilization protocol IF REQUIRED
-	 */
-	// Run stabilization protocol if the hash table size is greater than zero and if there has been a changed in the ring
-	bool change = false;
-	if (curMemList.size() != ring.size()) change = true;
-	else {
-		for (int i =0;i<curMemList.size() && i < ring.size();i++){
-			if(curMemList[i].nodeAddress == ring[i].nodeAddress)continue;
-			change = true;
-			break;
+	// Run stabilization protocol if there has been a change in the ring
+	if ( ring.size() > 1 && change && !memberNode->bLeaving ) {
+		stabilizationProtocol();
+	}
+	else if ( change && lingering ) {
+		for ( auto it = ht.begin(); it != ht.end(); it++ ) {
+			ReplicaView nodevec = replicasOf(it->first);
+			for ( int i = 0; i < nodevec.size(); i++ ) {
+				send(&nodevec[i].nodeAddress, Message(g_transID++, memberNode->addr, CREATE, it->first, it->second, PRIMARY).toString());
+			}
 		}
 	}
-    if (curMemList.size() > 1 && change) {
-        ring = curMemList;
-        stabilizationProtocol();
-    }
 }
 
 /**
- * FUNCTION NAME: getMemberhipList
- *
- * DESCRIPTION: This function goes through the membership list from the Membership protocol/MP1 and
- * 				i) generates the hash code for each member
- * 				ii) populates the ring member in MP2Node class
- * 				It returns a vector of Nodes. Each element in the vector contain the following fields:
- * 				a) Address of the node
- * 				b) Hash code obtained by consistent hashing of the Address
+ * FUNCTION NAME: ringBefore
+ *
+ * DESCRIPTION: Ring order, by hash code and then by address so nodes whose
+ * 				addresses hash to the same position keep a fixed order
  */
-vector<Node> MP2Node::getMembershipList() {
-	unsigned int i;
-	vector<Node> curMemList;
-    for (i = 0; i < this->memberNode->memberList.size(); i++) {
-        Address addressOfThisMember;
-        int id = this->memberNode->memberList.at(i).getid();
-        short port = this->memberNode->memberList.at(i).getport();
-        memcpy(&addressOfThisMember.addr[0], &id, sizeof(int));
-        memcpy(&addressOfThisMember.addr[4], &port, sizeof(short));
-        curMemList.emplace_back(Node(addressOfThisMember));
-        //add the curr node to the ring list
-        
-    }
-    curMemList.emplace_back(Node(memberNode->addr));
-	return curMemList;
+static bool ringBefore(const Node &a, const Node &b) {
+	if ( a.nodeHashCode != b.nodeHashCode ) {
+		return a.nodeHashCode < b.nodeHashCode;
+	}
+	return memcmp(a.nodeAddress.addr, b.nodeAddress.addr, sizeof(a.nodeAddress.addr)) < 0;
+}
+
+/**
+ * FUNCTION NAME: ringMerge
+ *
+ * DESCRIPTION: Take the virtual nodes of the nodes in removed out of the ring, and
+ * 				merge the virtual nodes in added in, sorted, in time linear in the size
+ * 				of the ring. Rebuilds the replica table if the ring changed and
+ * 				empties added and removed.
+ *
+ * RETURNS:
+ * true if the ring changed
+ */
+bool MP2Node::ringMerge(vector<Node> &added, vector<Address> &removed) {
+	size_t kept = 0;
+
+	for ( size_t i = 0; i < ring.size(); i++ ) {
+		bool gone = false;
+		for ( size_t j = 0; j < removed.size(); j++ ) {
+			gone = gone || ring[i].nodeAddress == removed[j];
+		}
+		if ( !gone ) {
+			ring[kept++] = ring[i];
+		}
+	}
+	bool change = kept != ring.size() || !added.empty();
+	ring.resize(kept);
+	sort(added.begin(), added.end(), ringBefore);
+	ring.insert(ring.end(), added.begin(), added.end());
+	inplace_merge(ring.begin(), ring.begin() + kept, ring.end(), ringBefore);
+	added.clear();
+	removed.clear();
+	if ( change ) {
+		buildReplicaTable();
+	}
+	return change;
+}
+
+/**
+ * FUNCTION NAME: ringInsert
+ *
+ * DESCRIPTION: Insert the VNODES virtual nodes of the node at address into the ring,
+ * 				each at its sorted position
+ */
+void MP2Node::ringInsert(Address address) {
+	for ( int v = 0; v < par->VNODES; v++ ) {
+		Node node(address, v);
+		ring.insert(upper_bound(ring.begin(), ring.end(), node, ringBefore), node);
+	}
+}
+
+/**
+ * FUNCTION NAME: ringErase
+ *
+ * DESCRIPTION: Remove the virtual nodes of the node at address from the ring
+ *
+ * RETURNS:
+ * true if the node was in the ring
+ */
+bool MP2Node::ringErase(Address address) {
+	bool found = false;
+
+	for ( int v = 0; v < par->VNODES; v++ ) {
+		Node node(address, v);
+		vector<Node>::iterator it = lower_bound(ring.begin(), ring.end(), node, ringBefore);
+		if ( it != ring.end() && it->nodeAddress == address ) {
+			ring.erase(it);
+			found = true;
+		}
+	}
+	return found;
 }
 
 /**
@@ -100,14 +192,14 @@ vector<Node> MP2Node::getMembershipList() {
  *
  * DESCRIPTION: This functions hashes the key and returns the position on the ring
  * 				HASH FUNCTION USED FOR CONSISTENT HASHING
+ * 				The ring spans every 64-bit value, like the node positions
  *
  * RETURNS:
  * size_t position on the ring
  */
 size_t MP2Node::hashFunction(string key) {
 	std::hash<string> hashFunc;
-	size_t ret = hashFunc(key);
-	return ret%RING_SIZE;
+	return hashFunc(key);
 }
 
 /**
@@ -120,22 +212,22 @@ size_t MP2Node::hashFunction(string key) {
  * 				3) Sends a message to the replica
  */
 void MP2Node::clientCreate(string key, string value) {
-    vector<Node> nodevec = findNodes(key);
-    trans_map.insert({ g_transID,transactions(key,value,"create",par->getcurrtime()) });
+    ReplicaView nodevec = replicasOf(key);
+    int transID = g_transID++;
+    trans_map.insert({ transID,transactions(key,value,"create",par->getcurrtime()) });
     for (int i = 0;i< nodevec.size();i++) {
-    	Node n = nodevec[i];
+    	Node &n = nodevec[i];
         if (*n.getAddress() == memberNode->addr) {
             ht.insert({ key,value });
-            trans_map[g_transID].success++;
-            trans_map[g_transID].count++;
-            log->logCreateSuccess(&memberNode->addr, false, g_transID, key, value);
+            trans_map[transID].success++;
+            trans_map[transID].count++;
+            log->logCreateSuccess(&memberNode->addr, false, transID, key, value);
         }
         else {
-            emulNet->ENsend(&memberNode->addr, &n.nodeAddress, Message(g_transID, memberNode->addr, CREATE, key, value, PRIMARY).toString());
+            send(&n.nodeAddress, Message(transID, memberNode->addr, CREATE, key, value, PRIMARY).toString());
         }
     }
-    myq.push(g_transID);
-    g_transID++;
+    myq.push(transID);
 }
 
 /**
@@ -151,25 +243,25 @@ void MP2Node::clientRead(string key){
 	/*
 	 * Implement this
 	 */
-    vector<Node> nodevec = findNodes(key);
-    trans_map.insert({ g_transID,transactions(key,"","read",par->getcurrtime()) });
+    ReplicaView nodevec = replicasOf(key);
+    int transID = g_transID++;
+    trans_map.insert({ transID,transactions(key,"","read",par->getcurrtime()) });
     for (int i = 0;i< nodevec.size();i++) {
-    	Node n = nodevec[i];
+    	Node &n = nodevec[i];
         if (*n.getAddress() == memberNode->addr) {
         	if (ht.count(key)){
-        		trans_map[g_transID].value = ht[key];
-        		trans_map[g_transID].success++;
-        		log->logReadSuccess(&memberNode->addr, false, g_transID, key,trans_map[g_transID].value);
+        		trans_map[transID].value = ht[key];
+        		trans_map[transID].success++;
+        		log->logReadSuccess(&memberNode->addr, false, transID, key,trans_map[transID].value);
         	}
-        	else log->logReadFail(&memberNode->addr, false, g_transID, key);
-            trans_map[g_transID].count++;
+        	else log->logReadFail(&memberNode->addr, false, transID, key);
+            trans_map[transID].count++;
         }
         else {
-            emulNet->ENsend(&memberNode->addr, &n.nodeAddress, Message(g_transID, memberNode->addr, READ, key).toString());
+            send(&n.nodeAddress, Message(transID, memberNode->addr, READ, key).toString());
         }
     }
-    myq.push(g_transID);
-    g_transID++;
+    myq.push(transID);
 }
 
 /**
@@ -182,27 +274,28 @@ void MP2Node::clientRead(string key){
  * 				3) Sends a message to the replica
  */
 void MP2Node::clientUpdate(string key, string value){
-    vector<Node> nodevec = findNodes(key);
+    ReplicaView nodevec = replicasOf(key);
+    int transID = g_transID++;
     int count = 0;
-    trans_map.insert({ g_transID,transactions(key,value,"update",par->getcurrtime()) });
-    for (Node n : nodevec) {
+    trans_map.insert({ transID,transactions(key,value,"update",par->getcurrtime()) });
+    for (int i = 0;i< nodevec.size();i++) {
+    	Node &n = nodevec[i];
         if (*n.getAddress() == memberNode->addr) {
         	if (ht.count(key)){
         		ht[key] = value;
-        		trans_map[g_transID].success++;
-        		log->logUpdateSuccess(&memberNode->addr, false, g_transID, key, value);
+        		trans_map[transID].success++;
+        		log->logUpdateSuccess(&memberNode->addr, false, transID, key, value);
         	}
-   			else log->logUpdateFail(&memberNode->addr, false, g_transID, key, value);
-            trans_map[g_transID].count++;
+   			else log->logUpdateFail(&memberNode->addr, false, transID, key, value);
+            trans_map[transID].count++;
             
         }
         else {
             count++;
-            emulNet->ENsend(&memberNode->addr, &n.nodeAddress, Message(g_transID, memberNode->addr, UPDATE, key, value, PRIMARY).toString());
+            send(&n.nodeAddress, Message(transID, memberNode->addr, UPDATE, key, value, PRIMARY).toString());
         }
     }
-    myq.push(g_transID);
-    g_transID++;
+    myq.push(transID);
 }
 
 /**
@@ -215,27 +308,27 @@ void MP2Node::clientUpdate(string key, string value){
  * 				3) Sends a message to the replica
  */
 void MP2Node::clientDelete(string key){
-    vector<Node> nodevec = findNodes(key);
+    ReplicaView nodevec = replicasOf(key);
+    int transID = g_transID++;
     int count = 0;
-    trans_map.insert({ g_transID,transactions(key,"","delete",par->getcurrtime()) });
+    trans_map.insert({ transID,transactions(key,"","delete",par->getcurrtime()) });
     for (int i = 0;i< nodevec.size();i++) {
-    	Node n = nodevec[i];
+    	Node &n = nodevec[i];
         if (*n.getAddress() == memberNode->addr) {
             if (ht.count(key)){
-            	trans_map[g_transID].success++;
+            	trans_map[transID].success++;
             	ht.erase(key);
-            	log->logDeleteSuccess(&memberNode->addr, false, g_transID, key);
+            	log->logDeleteSuccess(&memberNode->addr, false, transID, key);
            	}
-            else log->logDeleteFail(&memberNode->addr, false,g_transID, key);
-            trans_map[g_transID].count++;
+            else log->logDeleteFail(&memberNode->addr, false,transID, key);
+            trans_map[transID].count++;
         }
         else {
             count++;
-            emulNet->ENsend(&memberNode->addr, &n.nodeAddress, Message(g_transID, memberNode->addr, DELETE,key).toString());
+            send(&n.nodeAddress, Message(transID, memberNode->addr, DELETE,key).toString());
         }
     }
-    myq.push(g_transID);
-    g_transID++;
+    myq.push(transID);
 }
 
 /**
@@ -341,7 +434,9 @@ void MP2Node::checkMessages() {
 		size = memberNode->mp2q.front().size;
 		memberNode->mp2q.pop();
 
-		string message(data, data + size);
+		char *payload = membership ? MP1Node::kvPayload(data, size) : data;
+		string message(payload, payload + size);
+		emulNet->ENrelease(data);
 
 		/*
 		 * Handle the message types here
@@ -356,16 +451,19 @@ void MP2Node::checkMessages() {
                 break;
             }
             trans = createKeyValue(currmsg.key, currmsg.value, currmsg.replica);
+            if (trans) passOn(currmsg);
             if (trans) log->logCreateSuccess(&memberNode->addr, false, currmsg.transID, currmsg.key, currmsg.value);
             else log->logCreateFail(&memberNode->addr, false, currmsg.transID, currmsg.key, currmsg.value);
             break;
         case(UPDATE):
             trans = updateKeyValue(currmsg.key, currmsg.value, currmsg.replica);
+            if (trans) passOn(currmsg);
             if (trans) log->logUpdateSuccess(&memberNode->addr, false, currmsg.transID, currmsg.key, currmsg.value);
             else log->logUpdateFail(&memberNode->addr, false, currmsg.transID, currmsg.key, currmsg.value);
             break;
         case (DELETE):
             trans = deletekey(currmsg.key);
+            if (trans) passOn(currmsg);
             if (trans) log->logDeleteSuccess(&memberNode->addr, false, currmsg.transID, currmsg.key);
             else log->logDeleteFail(&memberNode->addr, false, currmsg.transID, currmsg.key);
             break;
@@ -408,18 +506,40 @@ void MP2Node::checkMessages() {
         }
         if (currmsg.type == READREPLY || currmsg.type == REPLY)cout<<"SHOULD NOT REACH HERE"<<endl;
         //send a reply msg
-        if (currmsg.type != READ) emulNet->ENsend(&memberNode->addr, &currmsg.fromAddr, Message(currmsg.transID, memberNode->addr, REPLY, trans).toString());
-        else emulNet->ENsend(&memberNode->addr, &currmsg.fromAddr, Message(currmsg.transID, memberNode->addr, value).toString());
+        if (currmsg.type != READ) send(&currmsg.fromAddr, Message(currmsg.transID, memberNode->addr, REPLY, trans).toString());
+        else send(&currmsg.fromAddr, Message(currmsg.transID, memberNode->addr, value).toString());
 
 	}
 	//check the queue for timed out transactions
 	while (!myq.empty() && ( !trans_map.count(myq.front()) || par->getcurrtime() - trans_map.at(myq.front()).time >=15)){
 		int id = myq.front();
-		if (trans_map.count(id)) logtrans(myq.front(),false);
+		if (trans_map.count(id)) {
+			string type = trans_map[id].type;
+			if (type != "replicate" && type != "deletekey") timeouts++;
+			logtrans(myq.front(),false);
+		}
 		myq.pop();
 	}
 }
 
+/**
+ * FUNCTION NAME: getTimeouts
+ *
+ * DESCRIPTION: Number of client requests this node coordinated that timed out
+ */
+long MP2Node::getTimeouts() {
+	return timeouts;
+}
+
+/**
+ * FUNCTION NAME: keyCount
+ *
+ * DESCRIPTION: Number of keys in the local hash table
+ */
+int MP2Node::keyCount() {
+	return ht.size();
+}
+
 void MP2Node::logtrans(int id, bool success) {
     string type = trans_map[id].type;
     string key = trans_map[id].key;
@@ -455,31 +575,110 @@ void MP2Node::logtrans(int id, bool success) {
  *
  * DESCRIPTION: Find the replicas of the given keyfunction
  * 				This function is responsible for finding the replicas of a key
+ * 				It returns copies of the nodes replicasOf finds, for callers that keep
+ * 				them across ring changes
  */
 vector<Node> MP2Node::findNodes(string key) {
-	size_t pos = hashFunction(key);
+	ReplicaView replicas = replicasOf(key);
 	vector<Node> addr_vec;
-	if (ring.size() >= 3) {
-		// if pos <= min || pos > max, the leader is the min
-		if (pos <= ring.at(0).getHashCode() || pos > ring.at(ring.size()-1).getHashCode()) {
-			addr_vec.emplace_back(ring.at(0));
-			addr_vec.emplace_back(ring.at(1));
-			addr_vec.emplace_back(ring.at(2));
-		}
-		else {
-			// go through the ring until pos <= node
-			for (int i=1; i<ring.size(); i++){
-				Node addr = ring.at(i);
-				if (pos <= addr.getHashCode()) {
-					addr_vec.emplace_back(addr);
-					addr_vec.emplace_back(ring.at((i+1)%ring.size()));
-					addr_vec.emplace_back(ring.at((i+2)%ring.size()));
-					break;
-				}
+	for (int i = 0; i < replicas.size(); i++) {
+		addr_vec.push_back(replicas[i]);
+	}
+	return addr_vec;
+}
+
+/**
+ * FUNCTION NAME: replicasOf
+ *
+ * DESCRIPTION: Replicas of the given key, found by a binary search of the ring
+ * 				positions for the first one at or after the key's position, wrapping
+ * 				around past the last one. The search is branch-free: the range halves
+ * 				every step whatever the comparison says. None when the ring has fewer
+ * 				than REPLICAS physical nodes.
+ */
+ReplicaView MP2Node::replicasOf(string key) {
+	int n = positions.size();
+	if ( replicaTable.empty() ) {
+		return ReplicaView(ring.data(), NULL, 0);
+	}
+	size_t pos = hashFunction(key);
+	const size_t *base = positions.data();
+	for ( int len = n; len > 1; ) {
+		int half = len / 2;
+		base = base[half] < pos ? base + half : base;
+		len -= half;
+	}
+	int i = (base - positions.data()) + (*base < pos);
+	if ( i == n ) {
+		i = 0;
+	}
+	return ReplicaView(ring.data(), &replicaTable[i * REPLICAS], REPLICAS);
+}
+
+/**
+ * FUNCTION NAME: buildReplicaTable
+ *
+ * DESCRIPTION: Rebuild positions and replicaTable from the ring, after it changed.
+ * 				The keys up to a virtual node's position go to that node and the next
+ * 				ones around the ring, skipping virtual nodes of a physical node that
+ * 				already holds them, until REPLICAS physical nodes do. The table stays
+ * 				empty while the ring has fewer physical nodes than that.
+ */
+void MP2Node::buildReplicaTable() {
+	int n = ring.size();
+
+	positions.resize(n);
+	for ( int i = 0; i < n; i++ ) {
+		positions[i] = ring[i].nodeHashCode;
+	}
+	// Every physical node has VNODES positions
+	if ( n / par->VNODES < REPLICAS ) {
+		replicaTable.clear();
+		return;
+	}
+	replicaTable.resize(n * REPLICAS);
+	for ( int i = 0; i < n; i++ ) {
+		int *row = &replicaTable[i * REPLICAS];
+		int found = 0;
+		for ( int j = i; found < REPLICAS; j = (j + 1) % n ) {
+			bool held = false;
+			for ( int k = 0; k < found; k++ ) {
+				held = held || ring[row[k]].nodeAddress == ring[j].nodeAddress;
+			}
+			if ( !held ) {
+				row[found++] = j;
 			}
 		}
 	}
-	return addr_vec;
+}
+
+/**
+ * FUNCTION NAME: keyShares
+ *
+ * DESCRIPTION: Share of the ring each physical node is the first replica for, the
+ * 				span from the previous position to each of its virtual nodes
+ *
+ * RETURNS:
+ * the shares, summing to 1, in no particular order
+ */
+vector<double> MP2Node::keyShares() {
+	unordered_map<nodekey, double> byNode;
+	vector<double> shares;
+	int n = ring.size();
+
+	for ( int i = 0; i < n; i++ ) {
+		int id;
+		short port;
+		memcpy(&id, &ring[i].nodeAddress.addr[0], sizeof(int));
+		memcpy(&port, &ring[i].nodeAddress.addr[4], sizeof(short));
+		// Unsigned wrap-around gives the span across zero for the first position
+		size_t span = positions[i] - positions[(i + n - 1) % n];
+		byNode[packKey(id, port)] += n == 1 ? 1.0 : span / 18446744073709551616.0;
+	}
+	for ( auto it = byNode.begin(); it != byNode.end(); it++ ) {
+		shares.push_back(it->second);
+	}
+	return shares;
 }
 
 /**
@@ -488,7 +687,8 @@ vector<Node> MP2Node::findNodes(string key) {
  * DESCRIPTION: Receive messages from EmulNet and push into the queue (mp2q)
  */
 bool MP2Node::recvLoop() {
-    if ( memberNode->bFailed ) {
+    // With PIGGYBACK_KV the membership protocol receives, and queues KV messages in mp2q
+    if ( memberNode->bFailed || membership ) {
     	return false;
     }
     else {
@@ -496,6 +696,30 @@ bool MP2Node::recvLoop() {
     }
 }
 
+/**
+ * FUNCTION NAME: setMembership
+ *
+ * DESCRIPTION: Send every message through the membership protocol of this node, which
+ * 				adds its recent membership changes, over the transport it shares
+ */
+void MP2Node::setMembership(MP1Node *membership) {
+	this->membership = membership;
+}
+
+/**
+ * FUNCTION NAME: send
+ *
+ * DESCRIPTION: Send a message to another node
+ */
+void MP2Node::send(Address *toaddr, string data) {
+	if ( membership ) {
+		membership->sendKV(toaddr, data);
+	}
+	else {
+		emulNet->ENsend(&memberNode->addr, toaddr, data);
+	}
+}
+
 /**
  * FUNCTION NAME: enqueueWrapper
  *
@@ -523,27 +747,85 @@ void MP2Node::stabilizationProtocol() {
         ReplicateKey(it->first);
     }
 }
+
+/**
+ * FUNCTION NAME: handoff
+ *
+ * DESCRIPTION: Hand the keys of this node off as it leaves. This node comes out of
+ * 				the ring and every key goes to the replicas it gains, the ones that
+ * 				were not replicas with this node in the ring. The local copies stay
+ * 				for the requests still on their way until the node stops.
+ */
+void MP2Node::handoff() {
+	vector<pair<string, vector<Node>>> before;
+	int copies = 0;
+
+	for ( auto it = ht.begin(); it != ht.end(); it++ ) {
+		before.push_back(make_pair(it->first, findNodes(it->first)));
+	}
+	ringErase(memberNode->addr);
+	buildReplicaTable();
+	for ( unsigned int i = 0; i < before.size(); i++ ) {
+		vector<Node> after = findNodes(before[i].first);
+		for ( unsigned int j = 0; j < after.size(); j++ ) {
+			bool held = false;
+			for ( unsigned int k = 0; k < before[i].second.size(); k++ ) {
+				held = held || before[i].second[k].nodeAddress == after[j].nodeAddress;
+			}
+			if ( !held ) {
+				send(&after[j].nodeAddress, Message(g_transID++, memberNode->addr, CREATE, before[i].first, ht[before[i].first], PRIMARY).toString());
+				copies++;
+			}
+		}
+	}
+	handedOff = true;
+	log->LOG(&memberNode->addr, "Handed off %d keys in %d copies", (int)before.size(), copies);
+}
+
+/**
+ * FUNCTION NAME: passOn
+ *
+ * DESCRIPTION: Once this node handed its keys off, send a write it still applied
+ * 				while lingering on to the replicas of the key in the ring without it.
+ * 				The coordinator counted this node in its quorum, and the other
+ * 				replicas may have taken their copies from the handoff already.
+ */
+void MP2Node::passOn(Message &message) {
+	if ( !handedOff ) {
+		return;
+	}
+	ReplicaView nodevec = replicasOf(message.key);
+	for ( int i = 0; i < nodevec.size(); i++ ) {
+		if ( message.type == DELETE ) {
+			send(&nodevec[i].nodeAddress, Message(g_transID++, memberNode->addr, DELETE, message.key).toString());
+		}
+		else {
+			send(&nodevec[i].nodeAddress, Message(g_transID++, memberNode->addr, message.type, message.key, message.value, PRIMARY).toString());
+		}
+	}
+}
+
 void MP2Node::ReplicateKey(string key) {
-    vector<Node> nodevec = findNodes(key);
+    ReplicaView nodevec = replicasOf(key);
+    int transID = g_transID++;
     int count = 0;
     bool in = false;
     for (int i = 0;i< nodevec.size();i++) {
-    	Node n = nodevec[i];
+    	Node &n = nodevec[i];
         if (*n.getAddress() == memberNode->addr) in = true;
         else {
-            emulNet->ENsend(&memberNode->addr, &n.nodeAddress,Message(g_transID, memberNode->addr, CREATE, key, ht[key], PRIMARY).toString());
+            send(&n.nodeAddress,Message(transID, memberNode->addr, CREATE, key, ht[key], PRIMARY).toString());
             count++;
         }
     }
     string type;
     if (!in) type = "deletekey";
     else type = "replicate";
-    trans_map.insert({ g_transID,transactions(key,"",type,par->getcurrtime()) });
+    trans_map.insert({ transID,transactions(key,"",type,par->getcurrtime()) });
     if (in){
-    	trans_map[g_transID].success++;
-    	trans_map[g_transID].count++;
+    	trans_map[transID].success++;
+    	trans_map[transID].count++;
     }
-    myq.push(g_transID);
-    g_transID++;
+    myq.push(transID);
     
 }
@@ -18,9 +18,36 @@
 #include "Params.h"
 #include "Message.h"
 #include "Queue.h"
+#include "MP1Node.h"
 #include <unordered_map>
 #include <list>
 
+/*
+ * Macros
+ */
+// Copies of every key
+#define REPLICAS 3
+
+/**
+ * CLASS NAME: ReplicaView
+ *
+ * DESCRIPTION: Replicas of a key, the ring nodes at the indices of a replica table
+ * 				row. Nothing is copied, the view is valid until the ring changes.
+ */
+class ReplicaView {
+private:
+	Node *ring;
+	const int *slots;
+	int count;
+public:
+	ReplicaView(Node *ring, const int *slots, int count): ring(ring), slots(slots), count(count) {}
+	int size() const {
+		return count;
+	}
+	Node &operator [](int i) const {
+		return ring[slots[i]];
+	}
+};
 
 /**
  * CLASS NAME: MP2Node
@@ -49,6 +76,12 @@ private:
 
 	// Ring
 	vector<Node> ring;
+	// Membership epoch the ring was last brought up to
+	long ringEpoch;
+	// Hash code of every ring node, in ring order, and REPLICAS ring indices per node:
+	// the replicas of the keys from the previous node's position (exclusive) to its own
+	vector<size_t> positions;
+	vector<int> replicaTable;
 	// Hash Table
 	unordered_map<string, string> ht;
 	// Member representing this member
@@ -57,12 +90,18 @@ private:
 	Params *par;
 	// Object of EmulNet
 	EmulNet * emulNet;
+	// Membership protocol messages go through with PIGGYBACK_KV, NULL otherwise
+	MP1Node * membership;
 	// Object of Log
 	Log * log;
 	//store a list of outgoing transactions when the node is acting as a coordinator
 	unordered_map<int, transactions> trans_map;
 	//queue to keep track of transactions times
 	queue<int> myq;
+	// Client requests of this coordinator that timed out
+	long timeouts;
+	// This node left the ring and handed its keys off
+	bool handedOff;
 
 public:
 	MP2Node(Member *memberNode, Params *par, EmulNet *emulNet, Log *log, Address *addressOfMember);
@@ -72,9 +111,11 @@ public:
 
 	// ring functionalities
 	void updateRing();
-	vector<Node> getMembershipList();
 	size_t hashFunction(string key);
-	void findNeighbors();
+	void ringInsert(Address address);
+	bool ringErase(Address address);
+	bool ringMerge(vector<Node> &added, vector<Address> &removed);
+	void buildReplicaTable();
 
 	// client side CRUD APIs
 	void clientCreate(string key, string value);
@@ -85,6 +126,8 @@ public:
 	// receive messages from Emulnet
 	bool recvLoop();
 	static int enqueueWrapper(void *env, char *buff, int size);
+	void setMembership(MP1Node *membership);
+	void send(Address *toaddr, string data);
 
 	// handle messages from receiving queue
 	void checkMessages();
@@ -94,6 +137,9 @@ public:
 
 	// find the addresses of nodes that are responsible for a key
 	vector<Node> findNodes(string key);
+	ReplicaView replicasOf(string key);
+	vector<double> keyShares();
+	int keyCount();
 
 	// server
 	bool createKeyValue(string key, string value, ReplicaType replica);
@@ -103,10 +149,13 @@ public:
 
 	// stabilization protocol - handle multiple failures
 	void stabilizationProtocol();
+	void handoff();
+	void passOn(Message &message);
 
 	//new helper functions
 	void ReplicateKey(string key);
 	void logtrans(int id, bool success);
+	long getTimeouts();
 
 	~MP2Node();
 };
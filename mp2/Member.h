@@ -8,6 +8,7 @@
 #define MEMBER_H_
 
 #include "stdincludes.h"
+#include "NodeIndex.h"
 
 /**
  * CLASS NAME: q_elt
@@ -42,6 +43,10 @@ public:
 		memcpy(&addr[0], &id, sizeof(int));
 		memcpy(&addr[4], &port, sizeof(short));
 	}
+	Address(int id, short port) {
+		memcpy(&addr[0], &id, sizeof(int));
+		memcpy(&addr[4], &port, sizeof(short));
+	}
 	string getAddress() {
 		int id = 0;
 		short port;
@@ -55,29 +60,50 @@ public:
 };
 
 /**
- * CLASS NAME: MemberListEntry
+ * CLASS NAME: MemberTable
  *
- * DESCRIPTION: Entry in the membership list
+ * DESCRIPTION: Membership table as parallel arrays, slot i of each array being one
+ * 				member: its packed id:port key, its heartbeat and the local time it
+ * 				was last refreshed. Heartbeats and times are ticks and fit in 32 bits,
+ * 				so an entry takes 16 bytes.
+ * 				Removing a slot moves the last entry into it.
  */
-class MemberListEntry {
+class MemberTable {
+private:
+	vector<nodekey> keys;
+	vector<int> heartbeats;
+	vector<int> timestamps;
 public:
+	int size();
+	bool empty();
+	nodekey getkey(int slot);
+	int getid(int slot);
+	short getport(int slot);
+	long getheartbeat(int slot);
+	long gettimestamp(int slot);
+	void setheartbeat(int slot, long heartbeat);
+	void settimestamp(int slot, long timestamp);
+	void add(int id, short port, long heartbeat, long timestamp);
+	void remove(int slot);
+	void clear();
+	void markFresh(long oldest, long since, vector<char> &fresh);
+};
+
+enum memberEventTYPE { MEMBER_JOINED, MEMBER_LEFT };
+
+/**
+ * CLASS NAME: MemberEvent
+ *
+ * DESCRIPTION: A node added to or removed from the membership list, with the
+ * 				membership epoch the change produced
+ */
+class MemberEvent {
+public:
+	int type;
 	int id;
 	short port;
-	long heartbeat;
-	long timestamp;
-	MemberListEntry(int id, short port, long heartbeat, long timestamp);
-	MemberListEntry(int id, short port);
-	MemberListEntry(): id(0), port(0), heartbeat(0), timestamp(0) {}
-	MemberListEntry(const MemberListEntry &anotherMLE);
-	MemberListEntry& operator =(const MemberListEntry &anotherMLE);
-	int getid();
-	short getport();
-	long getheartbeat();
-	long gettimestamp();
-	void setid(int id);
-	void setport(short port);
-	void setheartbeat(long hearbeat);
-	void settimestamp(long timestamp);
+	long epoch;
+	MemberEvent(int type, int id, short port, long epoch): type(type), id(id), port(port), epoch(epoch) {}
 };
 
 /**
@@ -96,6 +122,8 @@ public:
 	bool inGroup;
 	// boolean indicating if this member has failed
 	bool bFailed;
+	// boolean indicating if this member announced a leave, it serves until it stops
+	bool bLeaving;
 	// number of my neighbors
 	int nnb;
 	// the node's own heartbeat
@@ -105,9 +133,13 @@ public:
 	// counter for ping timeout
 	int timeOutCounter;
 	// Membership table
-	vector<MemberListEntry> memberList;
-	// My position in the membership table
-	vector<MemberListEntry>::iterator myPos;
+	MemberTable memberList;
+	// Membership epoch, advanced by every join and removal
+	long epoch;
+	// True once a consumer drains events, nothing is queued before that
+	bool watchEvents;
+	// Membership changes not yet consumed
+	queue<MemberEvent> events;
 	// Queue for failure detection messages
 	queue<q_elt> mp1q;
 	// Queue for KVstore messages
@@ -115,7 +147,7 @@ public:
 	/**
 	 * Constructor
 	 */
-	Member(): inited(false), inGroup(false), bFailed(false), nnb(0), heartbeat(0), pingCounter(0), timeOutCounter(0) {}
+	Member(): inited(false), inGroup(false), bFailed(false), bLeaving(false), nnb(0), heartbeat(0), pingCounter(0), timeOutCounter(0), epoch(0), watchEvents(false) {}
 	// copy constructor
 	Member(const Member &anotherMember);
 	// Assignment operator overloading
@@ -0,0 +1,63 @@
+/**********************************
+ * FILE NAME: MsgPool.h
+ *
+ * DESCRIPTION: Header file of the size-class message pool
+ **********************************/
+
+#ifndef _MSGPOOL_H_
+#define _MSGPOOL_H_
+
+#include "stdincludes.h"
+#include <mutex>
+
+/*
+ * Macros
+ */
+#define POOL_CLASSES 4
+#define POOL_SLAB_BLOCKS 64
+
+/**
+ * Struct Name: pool_hdr
+ *
+ * DESCRIPTION: Header in front of every block, records the size class it belongs to
+ */
+typedef union pool_hdr {
+	int sizeClass;
+	long long align;
+}pool_hdr;
+
+/**
+ * CLASS NAME: MsgPool
+ *
+ * DESCRIPTION: Slab allocator for message buffers. Blocks are carved out of slabs
+ * 				of POOL_SLAB_BLOCKS and recycled through one free list per size class.
+ * 				The largest class is the maximum message size. In shared mode every
+ * 				alloc and release takes a lock so that several threads can use it.
+ */
+class MsgPool {
+private:
+	int classSize[POOL_CLASSES];
+	vector<void *> freeList[POOL_CLASSES];
+	vector<void *> slabs;
+	unsigned long hits[POOL_CLASSES];
+	unsigned long misses[POOL_CLASSES];
+	unsigned long inUse[POOL_CLASSES];
+	unsigned long highWater[POOL_CLASSES];
+	unsigned long oversize;
+	bool shared;
+	std::mutex lock;
+	int classOf(int size);
+	void refill(int sizeClass);
+	MsgPool(const MsgPool &anotherPool);
+	MsgPool& operator = (const MsgPool &anotherPool);
+public:
+	MsgPool();
+	void init(int maxSize);
+	void *alloc(int size);
+	void release(void *ptr);
+	void setShared(bool on);
+	void report(FILE *file);
+	virtual ~MsgPool();
+};
+
+#endif /* _MSGPOOL_H_ */
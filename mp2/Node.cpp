@@ -19,6 +19,14 @@ Node::Node(Address address) {
 	computeHashCode();
 }
 
+/**
+ * constructor of the virtual node vnode of the node at address
+ */
+Node::Node(Address address, int vnode) {
+	this->nodeAddress = address;
+	computeHashCode(vnode);
+}
+
 /**
  * Destructor
  */
@@ -28,9 +36,18 @@ Node::~Node() {}
  * FUNCTION NAME: computeHashCode
  *
  * DESCRIPTION: This function computes the hash code of the node address
+ * 				The position of virtual node vnode of the address on the 64-bit ring,
+ * 				the SplitMix64 finalizer of the packed id:port and vnode
  */
-void Node::computeHashCode() {
-	nodeHashCode = hashFunc(nodeAddress.addr)%RING_SIZE;
+void Node::computeHashCode(int vnode) {
+	int id;
+	short port;
+	memcpy(&id, &nodeAddress.addr[0], sizeof(int));
+	memcpy(&port, &nodeAddress.addr[4], sizeof(short));
+	unsigned long long x = (packKey(id, port) << 16 | (unsigned short)vnode) + 0x9E3779B97F4A7C15ULL;
+	x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+	nodeHashCode = x ^ (x >> 31);
 }
 
 /**
@@ -14,13 +14,13 @@ class Node {
 public:
 	Address nodeAddress;
 	size_t nodeHashCode;
-	std::hash<string> hashFunc;
 	Node();
 	Node(Address address);
+	Node(Address address, int vnode);
 	Node(const Node& another);
 	Node& operator=(const Node& another);
 	bool operator < (const Node& another) const;
-	void computeHashCode();
+	void computeHashCode(int vnode = 0);
 	size_t getHashCode();
 	Address * getAddress();
 	void setHashCode(size_t hashCode);
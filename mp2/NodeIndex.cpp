@@ -0,0 +1,147 @@
+/**********************************
+ * FILE NAME: NodeIndex.cpp
+ *
+ * DESCRIPTION: Definition of the flat node index
+ **********************************/
+
+#include "NodeIndex.h"
+
+/**
+ * Constructor
+ */
+NodeIndex::NodeIndex() {
+	clear();
+}
+
+/**
+ * Destructor
+ */
+NodeIndex::~NodeIndex() {}
+
+/**
+ * FUNCTION NAME: home
+ *
+ * DESCRIPTION: Preferred bucket of a key, Fibonacci hashing of the packed key
+ */
+unsigned int NodeIndex::home(nodekey key) {
+	return (unsigned int)((key * 0x9E3779B97F4A7C15ULL) >> 32) & mask;
+}
+
+/**
+ * FUNCTION NAME: find
+ *
+ * DESCRIPTION: Value stored for key
+ *
+ * RETURNS:
+ * the value, -1 if key is not in the index
+ */
+int NodeIndex::find(nodekey key) {
+	for ( unsigned int b = home(key); keys[b] != NODEKEY_EMPTY; b = (b + 1) & mask ) {
+		if ( keys[b] == key ) {
+			return values[b];
+		}
+	}
+	return -1;
+}
+
+/**
+ * FUNCTION NAME: contains
+ *
+ * DESCRIPTION: True if key is in the index
+ */
+bool NodeIndex::contains(nodekey key) {
+	return find(key) >= 0;
+}
+
+/**
+ * FUNCTION NAME: set
+ *
+ * DESCRIPTION: Insert key or overwrite its value
+ */
+void NodeIndex::set(nodekey key, int value) {
+	unsigned int b;
+
+	if ( 2 * (count + 1) > (int)keys.size() ) {
+		grow();
+	}
+	for ( b = home(key); keys[b] != NODEKEY_EMPTY; b = (b + 1) & mask ) {
+		if ( keys[b] == key ) {
+			values[b] = value;
+			return;
+		}
+	}
+	keys[b] = key;
+	values[b] = value;
+	count++;
+}
+
+/**
+ * FUNCTION NAME: erase
+ *
+ * DESCRIPTION: Remove key. Later entries of the same probe run are moved back
+ * 				into the hole when their home bucket allows it.
+ */
+void NodeIndex::erase(nodekey key) {
+	unsigned int hole, b, h;
+
+	for ( hole = home(key); keys[hole] != key; hole = (hole + 1) & mask ) {
+		if ( keys[hole] == NODEKEY_EMPTY ) {
+			return;
+		}
+	}
+	count--;
+
+	for ( b = (hole + 1) & mask; keys[b] != NODEKEY_EMPTY; b = (b + 1) & mask ) {
+		h = home(keys[b]);
+		// Entry at b may move to hole only if its home is not in (hole, b]
+		if ( ((b - h) & mask) >= ((b - hole) & mask) ) {
+			keys[hole] = keys[b];
+			values[hole] = values[b];
+			hole = b;
+		}
+	}
+	keys[hole] = NODEKEY_EMPTY;
+}
+
+/**
+ * FUNCTION NAME: clear
+ *
+ * DESCRIPTION: Remove every key
+ */
+void NodeIndex::clear() {
+	keys.assign(NODEINDEX_MINCAP, NODEKEY_EMPTY);
+	values.assign(NODEINDEX_MINCAP, -1);
+	mask = NODEINDEX_MINCAP - 1;
+	count = 0;
+}
+
+/**
+ * FUNCTION NAME: size
+ *
+ * DESCRIPTION: Number of keys in the index
+ */
+int NodeIndex::size() {
+	return count;
+}
+
+/**
+ * FUNCTION NAME: grow
+ *
+ * DESCRIPTION: Double the capacity and re-insert every key
+ */
+void NodeIndex::grow() {
+	vector<nodekey> oldKeys;
+	vector<int> oldValues;
+
+	oldKeys.swap(keys);
+	oldValues.swap(values);
+	keys.assign(oldKeys.size() * 2, NODEKEY_EMPTY);
+	values.assign(oldKeys.size() * 2, -1);
+	mask = keys.size() - 1;
+	count = 0;
+	for ( unsigned int i = 0; i < oldKeys.size(); i++ ) {
+		if ( oldKeys[i] != NODEKEY_EMPTY ) {
+			set(oldKeys[i], oldValues[i]);
+		}
+	}
+}
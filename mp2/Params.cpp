@@ -1,67 +1,315 @@
-/**********************************
- * FILE NAME: Params.cpp
- *
- * DESCRIPTION: Definition of Parameter class
- **********************************/
-
-#include "Params.h"
-
-/**
- * Constructor
- */
-Params::Params(): PORTNUM(8001) {}
-
-/**
- * FUNCTION NAME: setparams
- *
- * DESCRIPTION: Set the parameters for this test case
- */
-void Params::setparams(char *config_file) {
-	//trace.funcEntry("Params::setparams");
-	char CRUD[10];
-	FILE *fp = fopen(config_file,"r");
-
-	fscanf(fp,"MAX_NNB: %d", &MAX_NNB);
-	fscanf(fp,"\nSINGLE_FAILURE: %d", &SINGLE_FAILURE);
-	fscanf(fp,"\nDROP_MSG: %d", &DROP_MSG);
-	fscanf(fp,"\nMSG_DROP_PROB: %lf", &MSG_DROP_PROB);
-	fscanf(fp,"\nCRUD_TEST: %s", CRUD);
-
-	if ( 0 == strcmp(CRUD, "CREATE") ) {
-		this->CRUDTEST = CREATE_TEST;
-	}
-	else if ( 0 == strcmp(CRUD, "READ") ) {
-		this->CRUDTEST = READ_TEST;
-	}
-	else if ( 0 == strcmp(CRUD, "UPDATE") ) {
-		this->CRUDTEST = UPDATE_TEST;
-	}
-	else if ( 0 == strcmp(CRUD, "DELETE") ) {
-		this->CRUDTEST = DELETE_TEST;
-	}
-
-	//printf("Parameters of the test case: %d %d %d %lf\n", MAX_NNB, SINGLE_FAILURE, DROP_MSG, MSG_DROP_PROB);
-
-	EN_GPSZ = MAX_NNB;
-	STEP_RATE=.25;
-	MAX_MSG_SIZE = 4000;
-	globaltime = 0;
-	dropmsg = 0;
-	allNodesJoined = 0;
-	for ( unsigned int i = 0; i < EN_GPSZ; i++ ) {
-		allNodesJoined += i;
-	}
-	fclose(fp);
-	//trace.funcExit("Params::setparams", SUCCESS);
-	return;
-}
-
-/**
- * FUNCTION NAME: getcurrtime
- *
- * DESCRIPTION: Return time since start of program, in time units.
- * 				For a 'real' implementation, this return time would be the UTC time.
- */
-int Params::getcurrtime(){
-    return globaltime;
-}
+/**********************************
+ * FILE NAME: Params.cpp
+ *
+ * DESCRIPTION: Definition of Parameter class
+ **********************************/
+
+#include "Params.h"
+
+/**
+ * Constructor
+ */
+Params::Params(): PORTNUM(8001) {}
+
+/**
+ * FUNCTION NAME: setparams
+ *
+ * DESCRIPTION: Set the parameters for this test case
+ */
+void Params::setparams(char *config_file) {
+	//trace.funcEntry("Params::setparams");
+	char CRUD[10];
+	FILE *fp = fopen(config_file,"r");
+
+	fscanf(fp,"MAX_NNB: %d", &MAX_NNB);
+	fscanf(fp,"\nSINGLE_FAILURE: %d", &SINGLE_FAILURE);
+	fscanf(fp,"\nDROP_MSG: %d", &DROP_MSG);
+	fscanf(fp,"\nMSG_DROP_PROB: %lf", &MSG_DROP_PROB);
+	fscanf(fp,"\nCRUD_TEST: %s", CRUD);
+
+	if ( 0 == strcmp(CRUD, "CREATE") ) {
+		this->CRUDTEST = CREATE_TEST;
+	}
+	else if ( 0 == strcmp(CRUD, "READ") ) {
+		this->CRUDTEST = READ_TEST;
+	}
+	else if ( 0 == strcmp(CRUD, "UPDATE") ) {
+		this->CRUDTEST = UPDATE_TEST;
+	}
+	else if ( 0 == strcmp(CRUD, "DELETE") ) {
+		this->CRUDTEST = DELETE_TEST;
+	}
+
+	//printf("Parameters of the test case: %d %d %d %lf\n", MAX_NNB, SINGLE_FAILURE, DROP_MSG, MSG_DROP_PROB);
+
+	EN_GPSZ = MAX_NNB;
+	STEP_RATE=.25;
+	MAX_MSG_SIZE = 4000;
+	globaltime = 0;
+	dropmsg = 0;
+	allNodesJoined = 0;
+	for ( unsigned int i = 0; i < EN_GPSZ; i++ ) {
+		allNodesJoined += i;
+	}
+	EN_BUFFSIZE = ENBUFFSIZE;
+	EN_OVERFLOW = DROP_NEWEST;
+	LATENCY_MIN = 1;
+	LATENCY_MAX = 1;
+	LATENCY_JITTER = 0;
+	EGRESS_BW = 0;
+	TRANSPORT = EMUL_TRANSPORT;
+	UDP_PORT = 20000;
+	GOSSIP_FANOUT = 2;
+	GOSSIP_INTERVAL = 1;
+	GOSSIP_ADAPTIVE = 0;
+	FAILURE_DETECTOR = FIXED_DETECTOR;
+	PHI_THRESHOLD = 8.0;
+	INTRODUCERS.assign(1, 1);
+	JOIN_TIMEOUT = 0;
+	PIGGYBACK_KV = 0;
+	PIGGYBACK_QUIET = 2;
+	LEAVE_TIME = 0;
+	LEAVE_COUNT = 0;
+	LEAVE_LINGER = 0;
+	VNODES = 1;
+	MEMBERSHIP = MEMBERSHIP_GOSSIP;
+	PING_TIMEOUT = 0;
+	PINGREQ_K = 3;
+	SUSPECT_TIMEOUT = 0;
+	PIGGYBACK_MAX = 6;
+	GOSSIP_MODE = GOSSIP_FULL;
+	FULL_SYNC_PERIOD = 10;
+	THREADS = 1;
+
+	// Optional "NAME: value" lines may follow the fixed ones
+	char name[64], value[64];
+	while ( 2 == fscanf(fp, " %63[^:]: %63s", name, value) ) {
+		setoption(name, value);
+	}
+	if ( THREADS < 1 ) {
+		THREADS = 1;
+	}
+	if ( THREADS > EN_GPSZ ) {
+		THREADS = EN_GPSZ;
+	}
+	if ( FULL_SYNC_PERIOD < 1 ) {
+		FULL_SYNC_PERIOD = 1;
+	}
+	if ( GOSSIP_FANOUT < 1 ) {
+		GOSSIP_FANOUT = 1;
+	}
+	if ( GOSSIP_INTERVAL < 1 ) {
+		GOSSIP_INTERVAL = 1;
+	}
+	// Nodes receive before they send in a tick, so a message is read the next tick at the earliest
+	if ( LATENCY_MIN < 1 ) {
+		printf("LATENCY_MIN %d raised to 1\n", LATENCY_MIN);
+		LATENCY_MIN = 1;
+	}
+	if ( LATENCY_MAX < LATENCY_MIN ) {
+		LATENCY_MAX = LATENCY_MIN;
+	}
+	// By default wait for the slowest possible round trip, plus a tick
+	if ( PING_TIMEOUT < 1 ) {
+		PING_TIMEOUT = 2 * (LATENCY_MAX + LATENCY_JITTER) + 1;
+	}
+	if ( PIGGYBACK_MAX < 0 ) {
+		PIGGYBACK_MAX = 0;
+	}
+	// Seeds must be nodes of this run
+	for ( unsigned int i = 0; i < INTRODUCERS.size(); ) {
+		if ( INTRODUCERS[i] < 1 || INTRODUCERS[i] > EN_GPSZ ) {
+			printf("Ignoring introducer %d\n", INTRODUCERS[i]);
+			INTRODUCERS.erase(INTRODUCERS.begin() + i);
+		}
+		else {
+			i++;
+		}
+	}
+	if ( INTRODUCERS.empty() ) {
+		INTRODUCERS.assign(1, 1);
+	}
+	// SWIM spreads its own updates, only heartbeat gossip rides on KV messages
+	if ( MEMBERSHIP == MEMBERSHIP_SWIM ) {
+		PIGGYBACK_KV = 0;
+	}
+	// By default give a seed the slowest possible round trip, plus the tick it answers in
+	if ( JOIN_TIMEOUT < 1 ) {
+		JOIN_TIMEOUT = 2 * (LATENCY_MAX + LATENCY_JITTER) + 2;
+	}
+	// By default serve until a request sent just before the LEAVE arrived got its answer
+	if ( LEAVE_LINGER < 1 ) {
+		LEAVE_LINGER = 2 * (LATENCY_MAX + LATENCY_JITTER) + 2;
+	}
+	if ( LEAVE_COUNT > EN_GPSZ - 1 ) {
+		LEAVE_COUNT = EN_GPSZ - 1;
+	}
+	// A ring position holds the vnode number in 16 bits
+	if ( VNODES < 1 ) {
+		VNODES = 1;
+	}
+	if ( VNODES > 65536 ) {
+		VNODES = 65536;
+	}
+	fclose(fp);
+	//trace.funcExit("Params::setparams", SUCCESS);
+	return;
+}
+
+/**
+ * FUNCTION NAME: setoption
+ *
+ * DESCRIPTION: Set one of the optional parameters of the test case
+ */
+void Params::setoption(char *name, char *value) {
+	if ( 0 == strcmp(name, "EN_BUFFSIZE") ) {
+		EN_BUFFSIZE = atoi(value);
+	}
+	else if ( 0 == strcmp(name, "EN_OVERFLOW") ) {
+		if ( 0 == strcmp(value, "DROP_NEWEST") ) {
+			EN_OVERFLOW = DROP_NEWEST;
+		}
+		else if ( 0 == strcmp(value, "DROP_OLDEST") ) {
+			EN_OVERFLOW = DROP_OLDEST;
+		}
+		else if ( 0 == strcmp(value, "BACK_PRESSURE") ) {
+			EN_OVERFLOW = BACK_PRESSURE;
+		}
+		else {
+			printf("Unknown EN_OVERFLOW policy %s\n", value);
+		}
+	}
+	else if ( 0 == strcmp(name, "LATENCY_MIN") ) {
+		LATENCY_MIN = atoi(value);
+	}
+	else if ( 0 == strcmp(name, "LATENCY_MAX") ) {
+		LATENCY_MAX = atoi(value);
+	}
+	else if ( 0 == strcmp(name, "LATENCY_JITTER") ) {
+		LATENCY_JITTER = atoi(value);
+	}
+	else if ( 0 == strcmp(name, "EGRESS_BW") ) {
+		EGRESS_BW = atoi(value);
+	}
+	else if ( 0 == strcmp(name, "TRANSPORT") ) {
+		if ( 0 == strcmp(value, "EMUL") ) {
+			TRANSPORT = EMUL_TRANSPORT;
+		}
+		else if ( 0 == strcmp(value, "UDP") ) {
+			TRANSPORT = UDP_TRANSPORT;
+		}
+		else {
+			printf("Unknown TRANSPORT %s\n", value);
+		}
+	}
+	else if ( 0 == strcmp(name, "UDP_PORT") ) {
+		UDP_PORT = atoi(value);
+	}
+	else if ( 0 == strcmp(name, "THREADS") ) {
+		THREADS = atoi(value);
+	}
+	else if ( 0 == strcmp(name, "GOSSIP_MODE") ) {
+		if ( 0 == strcmp(value, "FULL") ) {
+			GOSSIP_MODE = GOSSIP_FULL;
+		}
+		else if ( 0 == strcmp(value, "DELTA") ) {
+			GOSSIP_MODE = GOSSIP_DELTA;
+		}
+		else {
+			printf("Unknown GOSSIP_MODE %s\n", value);
+		}
+	}
+	else if ( 0 == strcmp(name, "FULL_SYNC_PERIOD") ) {
+		FULL_SYNC_PERIOD = atoi(value);
+	}
+	else if ( 0 == strcmp(name, "GOSSIP_FANOUT") ) {
+		GOSSIP_FANOUT = atoi(value);
+	}
+	else if ( 0 == strcmp(name, "GOSSIP_INTERVAL") ) {
+		GOSSIP_INTERVAL = atoi(value);
+	}
+	else if ( 0 == strcmp(name, "GOSSIP_ADAPTIVE") ) {
+		GOSSIP_ADAPTIVE = atoi(value);
+	}
+	else if ( 0 == strcmp(name, "MEMBERSHIP") ) {
+		if ( 0 == strcmp(value, "GOSSIP") ) {
+			MEMBERSHIP = MEMBERSHIP_GOSSIP;
+		}
+		else if ( 0 == strcmp(value, "SWIM") ) {
+			MEMBERSHIP = MEMBERSHIP_SWIM;
+		}
+		else {
+			printf("Unknown MEMBERSHIP %s\n", value);
+		}
+	}
+	else if ( 0 == strcmp(name, "PING_TIMEOUT") ) {
+		PING_TIMEOUT = atoi(value);
+	}
+	else if ( 0 == strcmp(name, "PINGREQ_K") ) {
+		PINGREQ_K = atoi(value);
+	}
+	else if ( 0 == strcmp(name, "SUSPECT_TIMEOUT") ) {
+		SUSPECT_TIMEOUT = atoi(value);
+	}
+	else if ( 0 == strcmp(name, "PIGGYBACK_MAX") ) {
+		PIGGYBACK_MAX = atoi(value);
+	}
+	else if ( 0 == strcmp(name, "FAILURE_DETECTOR") ) {
+		if ( 0 == strcmp(value, "FIXED") ) {
+			FAILURE_DETECTOR = FIXED_DETECTOR;
+		}
+		else if ( 0 == strcmp(value, "PHI") ) {
+			FAILURE_DETECTOR = PHI_DETECTOR;
+		}
+		else {
+			printf("Unknown FAILURE_DETECTOR %s\n", value);
+		}
+	}
+	else if ( 0 == strcmp(name, "PHI_THRESHOLD") ) {
+		PHI_THRESHOLD = atof(value);
+	}
+	else if ( 0 == strcmp(name, "INTRODUCERS") ) {
+		// Comma separated node ids, "1,2,3"
+		INTRODUCERS.clear();
+		for ( char *id = strtok(value, ","); id != NULL; id = strtok(NULL, ",") ) {
+			INTRODUCERS.push_back(atoi(id));
+		}
+	}
+	else if ( 0 == strcmp(name, "JOIN_TIMEOUT") ) {
+		JOIN_TIMEOUT = atoi(value);
+	}
+	else if ( 0 == strcmp(name, "PIGGYBACK_KV") ) {
+		PIGGYBACK_KV = atoi(value);
+	}
+	else if ( 0 == strcmp(name, "PIGGYBACK_QUIET") ) {
+		PIGGYBACK_QUIET = atoi(value);
+	}
+	else if ( 0 == strcmp(name, "LEAVE_TIME") ) {
+		LEAVE_TIME = atoi(value);
+	}
+	else if ( 0 == strcmp(name, "LEAVE_COUNT") ) {
+		LEAVE_COUNT = atoi(value);
+	}
+	else if ( 0 == strcmp(name, "LEAVE_LINGER") ) {
+		LEAVE_LINGER = atoi(value);
+	}
+	else if ( 0 == strcmp(name, "VNODES") ) {
+		VNODES = atoi(value);
+	}
+	else if ( 0 == strcmp(name, "STEP_RATE") ) {
+		STEP_RATE = atof(value);
+	}
+	else {
+		printf("Unknown parameter %s\n", name);
+	}
+}
+
+/**
+ * FUNCTION NAME: getcurrtime
+ *
+ * DESCRIPTION: Return time since start of program, in time units.
+ * 				For a 'real' implementation, this return time would be the UTC time.
+ */
+int Params::getcurrtime(){
+    return globaltime;
+}
@@ -0,0 +1,45 @@
+/**********************************
+ * FILE NAME: ThreadPool.h
+ *
+ * DESCRIPTION: Header file of the per-tick thread pool
+ **********************************/
+
+#ifndef _THREADPOOL_H_
+#define _THREADPOOL_H_
+
+#include "stdincludes.h"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+/**
+ * CLASS NAME: ThreadPool
+ *
+ * DESCRIPTION: Fixed set of threads that run one job at a time. run() hands the
+ * 				job to every slot, slot 0 being the calling thread, and returns
+ * 				once all slots are done, which makes it the barrier between phases.
+ */
+class ThreadPool {
+private:
+	int size;
+	vector<std::thread> threads;
+	std::mutex lock;
+	std::condition_variable started;
+	std::condition_variable finished;
+	std::function<void(int)> job;
+	// Bumped for every job, workers wait for it to change
+	long generation;
+	int running;
+	bool stopping;
+	void work(int slot);
+	ThreadPool(const ThreadPool &anotherPool);
+	ThreadPool& operator = (const ThreadPool &anotherPool);
+public:
+	ThreadPool(int size);
+	virtual ~ThreadPool();
+	int getSize();
+	void run(std::function<void(int)> job);
+};
+
+#endif /* _THREADPOOL_H_ */
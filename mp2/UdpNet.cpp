@@ -0,0 +1,269 @@
+/**********************************
+ * FILE NAME: UdpNet.cpp
+ *
+ * DESCRIPTION: Loopback UDP transport, definition
+ **********************************/
+
+#include "UdpNet.h"
+
+/**
+ * Constructor
+ */
+UdpNet::UdpNet(Params *p, int basePort): EmulNet(p), basePort(basePort), pending(0), polledAt(-1) {
+	epfd = epoll_create1(0);
+	if ( epfd < 0 ) {
+		perror("epoll_create1");
+		exit(1);
+	}
+}
+
+/**
+ * Destructor
+ */
+UdpNet::~UdpNet() {
+	for ( unsigned int i = 0; i < sockets.size(); i++ ) {
+		if ( sockets[i] >= 0 ) {
+			close(sockets[i]);
+		}
+	}
+	if ( epfd >= 0 ) {
+		close(epfd);
+	}
+}
+
+/**
+ * FUNCTION NAME: socketOf
+ *
+ * DESCRIPTION: Socket bound to the local port of node id. Opened on first use so
+ * 				that an UdpNet which never sees ENinit still works.
+ */
+int UdpNet::socketOf(int id) {
+	struct sockaddr_in sin;
+	struct epoll_event ev;
+	int bufsize = UDP_RCVBUF;
+	int fd;
+
+	assert(id >= 0);
+	if ( id >= (int)sockets.size() ) {
+		sockets.resize(id + 1, -1);
+		readable.resize(id + 1, false);
+		outbox.resize(id + 1);
+	}
+	if ( sockets[id] >= 0 ) {
+		return sockets[id];
+	}
+
+	fd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK, 0);
+	if ( fd < 0 ) {
+		perror("socket");
+		exit(1);
+	}
+	setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &bufsize, sizeof(bufsize));
+
+	memset(&sin, 0, sizeof(sin));
+	sin.sin_family = AF_INET;
+	sin.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	sin.sin_port = htons(basePort + id);
+	if ( bind(fd, (struct sockaddr *)&sin, sizeof(sin)) < 0 ) {
+		perror("bind");
+		exit(1);
+	}
+
+	memset(&ev, 0, sizeof(ev));
+	ev.events = EPOLLIN;
+	ev.data.u32 = id;
+	epoll_ctl(epfd, EPOLL_CTL_ADD, fd, &ev);
+
+	sockets[id] = fd;
+	return fd;
+}
+
+/**
+ * FUNCTION NAME: ENinit
+ *
+ * DESCRIPTION: Assign the node id and open its socket
+ */
+void *UdpNet::ENinit(Address *myaddr, short port) {
+	EmulNet::ENinit(myaddr, port);
+	socketOf(*(int *)(myaddr->addr));
+	return myaddr;
+}
+
+/**
+ * FUNCTION NAME: ENpost
+ *
+ * DESCRIPTION: Queue an admitted message for the next sendmmsg of its sender
+ *
+ * RETURNS:
+ * size
+ */
+int UdpNet::ENpost(en_msg *em) {
+	int src = *(int *)(em->from.addr);
+
+	socketOf(src);
+	outbox[src].push_back(em);
+	pending++;
+	countMsg(sent_msgs, src, par->getcurrtime());
+	return em->size;
+}
+
+/**
+ * FUNCTION NAME: sendBatch
+ *
+ * DESCRIPTION: Send up to UDP_BATCH messages of one sender with a single sendmmsg.
+ * 				Each datagram is the en_msg header followed by the payload.
+ */
+void UdpNet::sendBatch(int src, en_msg **batch, int count) {
+	struct mmsghdr msgs[UDP_BATCH];
+	struct iovec iovs[UDP_BATCH];
+	struct sockaddr_in dests[UDP_BATCH];
+	int i, sent = 0;
+
+	memset(msgs, 0, sizeof(msgs));
+	for ( i = 0; i < count; i++ ) {
+		memset(&dests[i], 0, sizeof(dests[i]));
+		dests[i].sin_family = AF_INET;
+		dests[i].sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+		dests[i].sin_port = htons(basePort + *(int *)(batch[i]->to.addr));
+		iovs[i].iov_base = batch[i];
+		iovs[i].iov_len = sizeof(en_msg) + batch[i]->size;
+		msgs[i].msg_hdr.msg_name = &dests[i];
+		msgs[i].msg_hdr.msg_namelen = sizeof(dests[i]);
+		msgs[i].msg_hdr.msg_iov = &iovs[i];
+		msgs[i].msg_hdr.msg_iovlen = 1;
+	}
+
+	while ( sent < count ) {
+		int ret = sendmmsg(sockets[src], msgs + sent, count - sent, 0);
+		if ( ret < 0 ) {
+			if ( errno == EINTR ) {
+				continue;
+			}
+			if ( errno != EAGAIN && errno != ENOBUFS ) {
+				perror("sendmmsg");
+			}
+			// The datagram at the head of the batch could not be queued
+			overflowDrops++;
+			sent++;
+			continue;
+		}
+		sent += ret;
+	}
+}
+
+/**
+ * FUNCTION NAME: flush
+ *
+ * DESCRIPTION: Send every queued message and give the buffers back to the pool
+ */
+void UdpNet::flush() {
+	for ( unsigned int src = 0; src < outbox.size(); src++ ) {
+		vector<en_msg *> &batch = outbox[src];
+		for ( unsigned int i = 0; i < batch.size(); i += UDP_BATCH ) {
+			sendBatch(src, &batch[i], min((int)(batch.size() - i), UDP_BATCH));
+		}
+		for ( unsigned int i = 0; i < batch.size(); i++ ) {
+			pool.release(batch[i]);
+		}
+		batch.clear();
+	}
+	pending = 0;
+	polledAt = -1;
+}
+
+/**
+ * FUNCTION NAME: poll
+ *
+ * DESCRIPTION: Find the sockets with datagrams waiting, without blocking. The
+ * 				sockets are level-triggered, so a socket stays ready until it is
+ * 				drained and a second wait would report the same ones again: a single
+ * 				wait with room for every socket finds them all.
+ */
+void UdpNet::poll() {
+	vector<struct epoll_event> events(max((size_t)1, sockets.size()));
+	int n = epoll_wait(epfd, events.data(), events.size(), 0);
+
+	for ( int i = 0; i < n; i++ ) {
+		readable[events[i].data.u32] = true;
+	}
+	polledAt = par->getcurrtime();
+}
+
+/**
+ * FUNCTION NAME: ENrecv
+ *
+ * DESCRIPTION: Deliver the datagrams waiting on this node's socket.
+ * 				The first call after a batch of sends flushes it and polls the sockets.
+ *
+ * RETURN:
+ * 0
+ */
+int UdpNet::ENrecv(Address *myaddr, int (* enq)(void *, char *, int), struct timeval *t, int times, void *queue) {
+	struct mmsghdr msgs[UDP_BATCH];
+	struct iovec iovs[UDP_BATCH];
+	en_msg *bufs[UDP_BATCH];
+	int id = *(int *)(myaddr->addr);
+	int fd = socketOf(id);
+	int i, n;
+
+	if ( pending > 0 ) {
+		flush();
+	}
+	if ( polledAt != par->getcurrtime() ) {
+		poll();
+	}
+	if ( !readable[id] ) {
+		return 0;
+	}
+	readable[id] = false;
+
+	for ( i = 0; i < UDP_BATCH; i++ ) {
+		bufs[i] = (en_msg *)pool.alloc(par->MAX_MSG_SIZE);
+	}
+	do {
+		memset(msgs, 0, sizeof(msgs));
+		for ( i = 0; i < UDP_BATCH; i++ ) {
+			iovs[i].iov_base = bufs[i];
+			iovs[i].iov_len = par->MAX_MSG_SIZE;
+			msgs[i].msg_hdr.msg_iov = &iovs[i];
+			msgs[i].msg_hdr.msg_iovlen = 1;
+		}
+		n = recvmmsg(fd, msgs, UDP_BATCH, MSG_DONTWAIT, NULL);
+		for ( i = 0; i < n; i++ ) {
+			if ( msgs[i].msg_len != sizeof(en_msg) + bufs[i]->size ) {
+				continue;
+			}
+			// The queue takes ownership of the buffer until ENrelease
+			(*enq)(queue, (char *)(bufs[i] + 1), bufs[i]->size);
+			countMsg(recv_msgs, id, par->getcurrtime());
+			bufs[i] = (en_msg *)pool.alloc(par->MAX_MSG_SIZE);
+		}
+	} while ( n == UDP_BATCH );
+
+	for ( i = 0; i < UDP_BATCH; i++ ) {
+		pool.release(bufs[i]);
+	}
+	return 0;
+}
+
+/**
+ * FUNCTION NAME: ENcleanup
+ *
+ * DESCRIPTION: Drop unsent messages, close the sockets and write the counters
+ */
+int UdpNet::ENcleanup() {
+	for ( unsigned int src = 0; src < outbox.size(); src++ ) {
+		for ( unsigned int i = 0; i < outbox[src].size(); i++ ) {
+			pool.release(outbox[src][i]);
+		}
+		outbox[src].clear();
+	}
+	pending = 0;
+	for ( unsigned int i = 0; i < sockets.size(); i++ ) {
+		if ( sockets[i] >= 0 ) {
+			close(sockets[i]);
+			sockets[i] = -1;
+		}
+	}
+	return EmulNet::ENcleanup();
+}
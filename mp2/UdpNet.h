@@ -0,0 +1,61 @@
+/**********************************
+ * FILE NAME: UdpNet.h
+ *
+ * DESCRIPTION: Loopback UDP transport, header file
+ **********************************/
+
+#ifndef _UDPNET_H_
+#define _UDPNET_H_
+
+#include "stdincludes.h"
+#include "EmulNet.h"
+#include <errno.h>
+#include <sys/socket.h>
+#include <sys/epoll.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+/*
+ * Macros
+ */
+// messages moved per sendmmsg/recvmmsg call
+#define UDP_BATCH 32
+#define UDP_RCVBUF (1 << 20)
+
+/**
+ * CLASS NAME: UdpNet
+ *
+ * DESCRIPTION: Runs the EmulNet contract over real UDP sockets on 127.0.0.1.
+ * 				Node id:port maps to local port basePort + id. Sends are batched per
+ * 				sender and flushed with sendmmsg when the receive phase starts.
+ * 				Readable sockets are found with a non-blocking epoll_wait and drained
+ * 				with recvmmsg straight into pool buffers.
+ */
+class UdpNet : public EmulNet
+{
+private:
+	int basePort;
+	int epfd;
+	// Socket of every node id, -1 until it is first used
+	vector<int> sockets;
+	// Set by epoll for sockets that have datagrams waiting
+	vector<bool> readable;
+	// Messages waiting for the next sendmmsg of each sender
+	vector< vector<en_msg *> > outbox;
+	int pending;
+	// Tick of the last epoll_wait
+	int polledAt;
+	int socketOf(int id);
+	void flush();
+	void poll();
+	void sendBatch(int src, en_msg **batch, int count);
+	int ENpost(en_msg *em);
+public:
+	UdpNet(Params *p, int basePort);
+	virtual ~UdpNet();
+	void *ENinit(Address *myaddr, short port);
+	int ENrecv(Address *myaddr, int (* enq)(void *, char *, int), struct timeval *t, int times, void *queue);
+	int ENcleanup();
+};
+
+#endif /* _UDPNET_H_ */
@@ -1,11 +1,13 @@
 #ifndef COMMON_H_
 #define COMMON_H_
 
+#include <atomic>
+
 /**
  * Global variable
  */
-// Transaction Id
-static int g_transID = 0;
+// Transaction Id, handed out atomically since nodes may run on several threads
+static std::atomic<int> g_transID(0);
 
 // message types, reply is the message from node to coordinator
 enum MessageType {CREATE, READ, UPDATE, DELETE, REPLY, READREPLY};
@@ -10,7 +10,6 @@
 /*
  * Macros
  */
-#define RING_SIZE 512
 #define FAILURE -1
 #define SUCCESS 0
 
@@ -21,6 +20,7 @@
 #include <math.h>
 #include <string.h>
 #include <stdlib.h>
+#include <limits.h>
 #include <assert.h>
 #include <time.h>
 #include <stdarg.h>